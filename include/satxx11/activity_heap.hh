@@ -0,0 +1,246 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Heap implementation
+ * Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+ * Copyright (c) 2007-2010, Niklas Sorensson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+ * OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SATXX11_ACTIVITY_HEAP_HH
+#define SATXX11_ACTIVITY_HEAP_HH
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <satxx11/assert_hotpath.hh>
+
+namespace satxx11 {
+
+/* A max-heap of variables ordered by activity (used by the decision
+ * heuristics).
+ *
+ * The heap is arity-ary (4 by default) so that it's shallower than a
+ * binary heap, and the children of a node are laid out so that they are
+ * all in the same cache line. Each heap entry carries a copy of the
+ * activity of its variable, so that comparing two children doesn't
+ * involve a lookup in another array. */
+template<unsigned int arity = 4>
+class activity_heap {
+public:
+	static_assert(arity == 2 || arity == 4 || arity == 8, "arity must be 2, 4, or 8");
+
+	struct entry {
+		float activity;
+		unsigned int variable;
+	};
+
+	static_assert(sizeof(entry) == 8, "sizeof(entry) == 8");
+
+	/* Positions of variables that are not in the heap */
+	static const unsigned int none = ~0U;
+
+	unsigned int size;
+	std::vector<entry> heap_data;
+	entry *heap;
+
+	/* Indexed by variable */
+	std::vector<float> activities;
+	std::vector<unsigned int> positions;
+
+	/* All the variables start out in the heap with activity 0. */
+	activity_heap(unsigned int nr_variables):
+		size(nr_variables),
+		heap_data(nr_variables + arity),
+		activities(nr_variables, 0),
+		positions(nr_variables)
+	{
+		/* Align the heap so that heap[1] (the first child of the
+		 * root) and thus every group of siblings starts at a
+		 * multiple of the group size. */
+		unsigned long group_size = arity * sizeof(entry);
+		unsigned long first_child = (unsigned long) (heap_data.data() + 1);
+		heap = heap_data.data() + ((group_size - first_child % group_size) % group_size) / sizeof(entry);
+
+		for (unsigned int i = 0; i < nr_variables; ++i) {
+			heap[i].activity = 0;
+			heap[i].variable = i;
+			positions[i] = i;
+		}
+	}
+
+	activity_heap(const activity_heap &) = delete;
+	activity_heap &operator=(const activity_heap &) = delete;
+
+	static unsigned int parent(unsigned int i)
+	{
+		return (i - 1) / arity;
+	}
+
+	static unsigned int first_child(unsigned int i)
+	{
+		return arity * i + 1;
+	}
+
+	void place(unsigned int i, entry x)
+	{
+		heap[i] = x;
+		positions[x.variable] = i;
+	}
+
+	void percolate_up(unsigned int i)
+	{
+		entry x = heap[i];
+
+		while (i > 0) {
+			unsigned int p = parent(i);
+			if (!(x.activity > heap[p].activity))
+				break;
+
+			place(i, heap[p]);
+			i = p;
+		}
+
+		place(i, x);
+	}
+
+	void percolate_down(unsigned int i)
+	{
+		unsigned int n = size;
+
+		entry x = heap[i];
+
+		while (true) {
+			unsigned int first = first_child(i);
+			if (first >= n)
+				break;
+
+			unsigned int last = std::min(first + arity, n);
+
+			unsigned int child = first;
+			for (unsigned int j = first + 1; j < last; ++j) {
+				if (heap[j].activity > heap[child].activity)
+					child = j;
+			}
+
+			if (x.activity >= heap[child].activity)
+				break;
+
+			place(i, heap[child]);
+			i = child;
+		}
+
+		place(i, x);
+	}
+
+	bool empty() const
+	{
+		return size == 0;
+	}
+
+	bool contains(unsigned int var) const
+	{
+		return positions[var] != none;
+	}
+
+	float activity(unsigned int var) const
+	{
+		return activities[var];
+	}
+
+	void insert(unsigned int var)
+	{
+		assert_hotpath(!contains(var));
+
+		unsigned int i = size++;
+		heap[i].activity = activities[var];
+		heap[i].variable = var;
+		positions[var] = i;
+
+		percolate_up(i);
+	}
+
+	/* Change the activity of a variable, whether it's in the heap
+	 * or not. */
+	void update(unsigned int var, float activity)
+	{
+		float old_activity = activities[var];
+		activities[var] = activity;
+
+		unsigned int i = positions[var];
+		if (i == none)
+			return;
+
+		heap[i].activity = activity;
+		if (activity > old_activity)
+			percolate_up(i);
+		else
+			percolate_down(i);
+	}
+
+	unsigned int top() const
+	{
+		assert_hotpath(size > 0);
+		return heap[0].variable;
+	}
+
+	unsigned int pop()
+	{
+		assert_hotpath(size > 0);
+
+		unsigned int var = heap[0].variable;
+		positions[var] = none;
+
+		if (--size) {
+			place(0, heap[size]);
+			percolate_down(0);
+		}
+
+		return var;
+	}
+
+	/* Multiply all activities by 2^exponent; this is exact and
+	 * preserves the order of the heap. */
+	void scale(int exponent)
+	{
+		for (unsigned int i = 0, n = activities.size(); i < n; ++i)
+			activities[i] = ldexpf(activities[i], exponent);
+		for (unsigned int i = 0; i < size; ++i)
+			heap[i].activity = ldexpf(heap[i].activity, exponent);
+	}
+};
+
+}
+
+#endif
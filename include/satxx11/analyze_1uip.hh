@@ -19,6 +19,7 @@
 #ifndef SATXX11_ANALYZE_1UIP_HH
 #define SATXX11_ANALYZE_1UIP_HH
 
+#include <cstdint>
 #include <vector>
 
 #include <satxx11/debug.hh>
@@ -33,9 +34,65 @@ class analyze_1uip {
 public:
 	Minimise minimise;
 
+	/* Scratch space that is kept between conflicts, so that analysing
+	 * a conflict doesn't allocate anything and only costs time in
+	 * proportion to the part of the implication graph it visits. seen
+	 * is all false between conflicts; touched lists the variables we
+	 * have to reset afterwards. */
+	std::vector<bool> seen;
+	std::vector<unsigned int> touched;
+	std::vector<literal> conflict_clause;
+
+	/* For counting distinct decision levels: a level has been counted
+	 * if its entry is equal to the current stamp. */
+	std::vector<uint64_t> level_stamps;
+	uint64_t stamp;
+
 	template<class Solver>
-	analyze_1uip(Solver &s)
+	analyze_1uip(Solver &s):
+		minimise(s),
+		seen(s.nr_variables, false),
+		level_stamps(s.nr_variables + 1, 0),
+		stamp(0)
+	{
+	}
+
+	/* Literal block distance, i.e. the number of distinct decision
+	 * levels among the (assigned) literals. */
+	template<class Solver, typename Literals>
+	unsigned int lbd(Solver &s, const Literals &v)
+	{
+		++stamp;
+
+		unsigned int n = 0;
+		for (literal lit: v) {
+			unsigned int level = s.state[lit.variable()].level;
+			if (level_stamps[level] != stamp) {
+				level_stamps[level] = stamp;
+				++n;
+			}
+		}
+
+		return n;
+	}
+
+	/* Learnt clauses that take part in a conflict get their LBD
+	 * recomputed; we keep the lowest value seen. Clauses that are
+	 * already at 2 or below can't get any better in practice. */
+	template<class Solver, typename Reason, typename Literals>
+	void use(Solver &s, const Reason &r, const Literals &v)
 	{
+		clause c = r.get_clause();
+		if (!c || !c.is_learnt())
+			return;
+
+		if (c.lbd() > 2) {
+			unsigned int new_lbd = lbd(s, v);
+			if (new_lbd < c.lbd())
+				c.set_lbd(new_lbd);
+		}
+
+		s.use(c);
 	}
 
 	template<class Solver>
@@ -44,17 +101,15 @@ public:
 		/* This algorithm comes from the MiniSat paper:
 		 * http://minisat.se/downloads/MiniSat.pdf */
 
-		std::vector<bool> seen(s.nr_variables, false);
-
 		assert(s.stack.decision_index > 0);
 		unsigned int trail_index = s.stack.trail_size;
 
 		unsigned int counter = 0;
-		std::vector<literal> conflict_clause;
+		conflict_clause.clear();
 
 		unsigned int variable;
-		std::vector<literal> reason;
-		s.conflict_reason.get_literals(reason);
+		auto reason = s.conflict_reason.literals(s.conflict_literal);
+		use(s, s.conflict_reason, reason);
 
 		while (true) {
 			/* Generic hook -- but our main intention is to let
@@ -70,9 +125,10 @@ public:
 					continue;
 
 				seen[variable] = true;
+				touched.push_back(variable);
 				s.resolve(lit);
 
-				unsigned int level = s.stack.levels[variable];
+				unsigned int level = s.state[variable].level;
 				if (level == s.stack.decision_index) {
 					++counter;
 				} else if (level > 0) {
@@ -93,15 +149,20 @@ public:
 				break;
 
 			/* Get next clause */
-			s.reasons[variable].get_literals(reason);
+			reason = s.state[variable].reason.literals(literal(variable, s.value(variable)));
+			use(s, s.state[variable].reason, reason);
 		}
 
 		if (conflict_clause.size() > 0)
 			minimise(s, seen, conflict_clause);
 
+		for (unsigned int var: touched)
+			seen[var] = false;
+		touched.clear();
+
 		unsigned int new_decision_index = 0;
 		for (literal l: conflict_clause) {
-			unsigned int level = s.stack.levels[l.variable()];
+			unsigned int level = s.state[l.variable()].level;
 
 			if (level > new_decision_index)
 				new_decision_index = level;
@@ -110,11 +171,13 @@ public:
 		literal asserting_literal = ~literal(variable, s.value(variable));
 		conflict_clause.push_back(asserting_literal);
 
+		unsigned int conflict_lbd = lbd(s, conflict_clause);
+
 		s.backtrack(new_decision_index);
 
 		/* XXX: The old code is faster because it doesn't need to
 		 * look for new watches. */
-		bool ok = s.attach_learnt(conflict_clause);
+		bool ok = s.attach_learnt(conflict_clause, conflict_lbd);
 		assert(ok);
 	}
 };
@@ -0,0 +1,174 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_BINARY_CNF_HH
+#define SATXX11_BINARY_CNF_HH
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <satxx11/cnf.hh>
+#include <satxx11/literal.hh>
+#include <satxx11/mapped_file.hh>
+#include <satxx11/system_error.hh>
+#include <satxx11/variable_remap.hh>
+
+namespace satxx11 {
+
+/* A binary CNF file is a cache of an already-parsed instance. It is laid
+ * out exactly like the in-memory clause list (class cnf) so that it can be
+ * used directly from a read-only mapping, without parsing anything:
+ *
+ *   header
+ *   uint32_t remap[nr_variables]     input variable for each solver variable
+ *   uint32_t literals[nr_literals]   encoded like class literal
+ *   (padding to an 8-byte boundary)
+ *   uint64_t ends[nr_clauses]        see cnf::ends
+ *
+ * Everything is stored in native byte order; the byte_order field lets us
+ * reject files written on a machine with a different byte order. */
+class binary_cnf {
+public:
+	static const uint32_t current_version = 1;
+
+	struct header {
+		char magic[8];
+		uint32_t version;
+		uint32_t byte_order;
+		uint32_t nr_variables;
+		uint32_t reserved;
+		uint64_t nr_literals;
+		uint64_t nr_clauses;
+	};
+
+	static_assert(sizeof(header) == 40, "sizeof(header) == 40");
+	static_assert(sizeof(literal) == sizeof(uint32_t), "sizeof(literal) == sizeof(uint32_t)");
+
+	static const char *magic()
+	{
+		return "SATXX11B";
+	}
+
+	static bool check(const char *data, unsigned long size)
+	{
+		return size >= sizeof(header) && !memcmp(data, magic(), 8);
+	}
+
+	static uint64_t ends_offset(const header &h)
+	{
+		uint64_t offset = sizeof(header)
+			+ h.nr_variables * sizeof(uint32_t)
+			+ h.nr_literals * sizeof(uint32_t);
+
+		return (offset + 7) & ~7UL;
+	}
+
+	static void write(FILE *fp, const void *data, unsigned long size)
+	{
+		if (size && fwrite(data, size, 1, fp) != 1)
+			throw system_error(errno);
+	}
+
+	static void save(FILE *fp, const variable_remap &variables, const cnf &clauses)
+	{
+		header h;
+		memcpy(h.magic, magic(), 8);
+		h.version = current_version;
+		h.byte_order = 0x01020304;
+		h.nr_variables = variables.size();
+		h.reserved = 0;
+		h.nr_literals = clauses.size() ? clauses.end_data()[clauses.size() - 1] : 0;
+		h.nr_clauses = clauses.size();
+
+		write(fp, &h, sizeof(h));
+		write(fp, variables.reverse.data(), h.nr_variables * sizeof(uint32_t));
+		write(fp, clauses.literal_data(), h.nr_literals * sizeof(uint32_t));
+
+		static const char padding[8] = {};
+		uint64_t offset = sizeof(header) + (h.nr_variables + h.nr_literals) * sizeof(uint32_t);
+		write(fp, padding, ends_offset(h) - offset);
+		write(fp, clauses.end_data(), h.nr_clauses * sizeof(uint64_t));
+	}
+
+	/* Take over the mapping of a binary CNF file. */
+	static void load(std::unique_ptr<mapped_file> file, variable_remap &variables, cnf &clauses)
+	{
+		if (variables.size() || clauses.size())
+			throw std::runtime_error("Binary CNF files cannot be combined with other input files");
+
+		header h;
+		memcpy(&h, file->data, sizeof(h));
+
+		if (h.version != current_version)
+			throw std::runtime_error("Unsupported binary CNF file version");
+		if (h.byte_order != 0x01020304)
+			throw std::runtime_error("Binary CNF file has the wrong byte order");
+
+		/* Check the counts on their own first so that the offset
+		 * computations below can't overflow. */
+		if (h.nr_literals > file->size / sizeof(uint32_t) || h.nr_clauses > file->size / sizeof(uint64_t))
+			throw std::runtime_error("Truncated or corrupt binary CNF file");
+		if (ends_offset(h) + h.nr_clauses * sizeof(uint64_t) != file->size)
+			throw std::runtime_error("Truncated or corrupt binary CNF file");
+
+		const uint32_t *remap = (const uint32_t *) (file->data + sizeof(header));
+		variables.reserve(h.nr_variables);
+		for (uint32_t i = 0; i < h.nr_variables; ++i) {
+			if (variables(remap[i]) != i)
+				throw std::runtime_error("Corrupt variable table in binary CNF file");
+		}
+
+		const literal *literals = (const literal *) (remap + h.nr_variables);
+		const uint64_t *ends = (const uint64_t *) (file->data + ends_offset(h));
+
+		/* The solver trusts the clause list completely, so make sure
+		 * that the clauses don't overlap or run past the end of the
+		 * literals, and that every literal refers to a known
+		 * variable. */
+		uint64_t begin = 0;
+		for (uint64_t i = 0; i < h.nr_clauses; ++i) {
+			uint64_t end = ends[i];
+			if (end < begin || end > h.nr_literals)
+				throw std::runtime_error("Corrupt clause table in binary CNF file");
+
+			for (; begin < end; ++begin) {
+				if (literals[begin].variable() >= h.nr_variables)
+					throw std::runtime_error("Corrupt literal in binary CNF file");
+			}
+		}
+
+		if (begin != h.nr_literals)
+			throw std::runtime_error("Truncated or corrupt binary CNF file");
+
+		clauses.mapped_literals = literals;
+		clauses.mapped_ends = ends;
+		clauses.nr_mapped_literals = h.nr_literals;
+		clauses.nr_mapped_clauses = h.nr_clauses;
+
+		clauses.file = std::move(file);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_BINARY_GRAPH_HH
+#define SATXX11_BINARY_GRAPH_HH
+
+#include <cstdint>
+#include <vector>
+
+#include <satxx11/assert_hotpath.hh>
+#include <satxx11/cnf.hh>
+#include <satxx11/literal.hh>
+
+namespace satxx11 {
+
+/* The binary implication graph of the original binary clauses, stored in
+ * compressed sparse row form: the literals implied by literal l (i.e. the
+ * other literals of the binary clauses containing ~l) are
+ * implied[offsets[l]] .. implied[offsets[l + 1] - 1].
+ *
+ * The graph is built once from the instance before the solver threads are
+ * created and is never modified after that, so all threads can share it. */
+class binary_graph {
+public:
+	class range {
+	public:
+		const literal *first;
+		const literal *last;
+
+		range(const literal *first, const literal *last):
+			first(first),
+			last(last)
+		{
+		}
+
+		const literal *begin() const
+		{
+			return first;
+		}
+
+		const literal *end() const
+		{
+			return last;
+		}
+	};
+
+	std::vector<uint64_t> offsets;
+	std::vector<literal> implied;
+
+	binary_graph(unsigned int nr_variables, const cnf &clauses):
+		offsets(2 * nr_variables + 1, 0)
+	{
+		/* Count the out-degree of each literal, shifted by one so that
+		 * the prefix sum gives us the start of each row. */
+		for (unsigned long i = 0, n = clauses.size(); i < n; ++i) {
+			cnf::span c = clauses[i];
+			if (c.size() != 2)
+				continue;
+
+			++offsets[(~c[0]) + 1];
+			++offsets[(~c[1]) + 1];
+		}
+
+		for (unsigned int i = 1; i < offsets.size(); ++i)
+			offsets[i] += offsets[i - 1];
+
+		implied.resize(offsets.back());
+
+		/* Fill in the rows, using the start of the next row as a
+		 * cursor; this leaves offsets[l] pointing at the start of row
+		 * l + 1, so shift everything back by one afterwards. */
+		for (unsigned long i = 0, n = clauses.size(); i < n; ++i) {
+			cnf::span c = clauses[i];
+			if (c.size() != 2)
+				continue;
+
+			implied[offsets[~c[0]]++] = c[1];
+			implied[offsets[~c[1]]++] = c[0];
+		}
+
+		for (unsigned int i = offsets.size() - 1; i > 0; --i)
+			offsets[i] = offsets[i - 1];
+		offsets[0] = 0;
+	}
+
+	binary_graph(const binary_graph &) = delete;
+	binary_graph &operator=(const binary_graph &) = delete;
+
+	unsigned long size() const
+	{
+		return implied.size() / 2;
+	}
+
+	range operator[](literal lit) const
+	{
+		assert_hotpath(lit + 1 < offsets.size());
+
+		const literal *data = implied.data();
+		return range(data + offsets[lit], data + offsets[lit + 1]);
+	}
+};
+
+}
+
+#endif
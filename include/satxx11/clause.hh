@@ -19,15 +19,15 @@
 #ifndef SATXX11_CLAUSE_HH
 #define SATXX11_CLAUSE_HH
 
-#include <cerrno>
+#include <algorithm>
 #include <cstdint>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include <satxx11/assert_hotpath.hh>
+#include <satxx11/clause_arena.hh>
 #include <satxx11/literal.hh>
-#include <satxx11/system_error.hh>
 
 namespace satxx11 {
 
@@ -37,139 +37,125 @@ public:
 	public:
 		/* XXX: Attempt to pack these.. We might also need flags for learnt, etc. */
 		uint32_t index;
-		uint16_t thread;
 		uint16_t size:15;
 		uint16_t learnt:1;
+
+		/* Where the last search for a new watch ended (see
+		 * propagate_clause). This is only a hint, so it doesn't
+		 * matter that it gets truncated for very long clauses, as
+		 * long as the reader checks that it is in range. */
+		uint16_t search:11;
+
+		/* Literal block distance ("glue"): the number of distinct
+		 * decision levels among the literals, as of the last time
+		 * we looked (capped at max_lbd). */
+		uint16_t lbd:5;
+
 		literal literals[0];
 
-		impl(uint16_t thread, uint32_t index, bool learnt, uint16_t size,
-			const std::vector<literal> &v):
+		impl(uint32_t index, bool learnt, uint16_t size,
+			const std::vector<literal> &v, unsigned int lbd):
 			index(index),
-			thread(thread),
 			size(size),
-			learnt(learnt)
+			learnt(learnt),
+			search(2),
+			lbd(std::min(lbd, max_lbd))
 		{
 			for (unsigned int i = 0; i < size; ++i)
 				literals[i] = v[i];
 		}
 	};
 
-	impl *data;
+	static const unsigned int max_lbd = 31;
 
-	explicit clause(impl *data = 0):
-		data(data)
-	{
-	}
+	/* Offset of the clause in the clause arena (0 means no clause) */
+	uint32_t ref;
 
-	clause(unsigned int thread, unsigned int index, bool learnt, const std::vector<literal> &v)
+	explicit clause(uint32_t ref = 0):
+		ref(ref)
 	{
-		unsigned int size = v.size();
-		assert(size >= 1);
-
-		void *ptr = ::malloc(sizeof(*data) + size * sizeof(data->literals[0]));
-		if (!ptr)
-			throw system_error(errno);
-
-		data = new (ptr) impl(thread, index, learnt, size, v);
 	}
 
-	template<typename... Args>
-	static void collect_literals(std::vector<literal> &v)
+	/* Number of arena words taken up by a clause of the given size */
+	static unsigned int nr_words(unsigned int size)
 	{
+		return (sizeof(impl) + size * sizeof(literal)) / sizeof(uint32_t);
 	}
 
-	template<typename... Args>
-	static void collect_literals(std::vector<literal> &v, int lit, Args... args)
+	impl *get() const
 	{
-		v.push_back(literal(lit));
-		collect_literals(v, args...);
+		assert_hotpath(ref);
+		return (impl *) (clause_arena::base + ref);
 	}
 
-	/* For convenience. */
-	template<typename... Args>
-	clause(unsigned int thread, unsigned int index, bool learnt, Args... args)
-	{
-		std::vector<literal> v;
-
-		collect_literals(v, args...);
-
-		unsigned int size = v.size();
-		assert(size >= 1);
-
-		void *ptr = ::malloc(sizeof(*data) + size * sizeof(data->literals[0]));
-		if (!ptr)
-			throw system_error(errno);
-
-		data = new (ptr) impl(thread, index, size, learnt, v);
-	}
-
-	void free()
+	bool operator<(const clause &other) const
 	{
-		::free((void *) data);
+		return ref < other.ref;
 	}
 
-	bool operator<(const clause &other) const
+	bool operator==(const clause &other) const
 	{
-		return data < other.data;
+		return ref == other.ref;
 	}
 
-	bool operator==(const clause &other) const
+	uint32_t index() const
 	{
-		return data == other.data;
+		return get()->index;
 	}
 
-	uint32_t thread() const
+	bool is_learnt() const
 	{
-		return data->thread;
+		return get()->learnt;
 	}
 
-	uint32_t index() const
+	unsigned int lbd() const
 	{
-		return data->index;
+		return get()->lbd;
 	}
 
-	bool is_learnt() const
+	void set_lbd(unsigned int lbd)
 	{
-		return data->learnt;
+		get()->lbd = std::min(lbd, max_lbd);
 	}
 
 	uint32_t size() const
 	{
-		return data->size;
+		return get()->size;
 	}
 
 	literal operator[](unsigned int i) const
 	{
-		assert_hotpath(data);
+		impl *data = get();
 		assert_hotpath(i < data->size);
 		return data->literals[i];
 	}
 
 	literal &operator[](unsigned int i)
 	{
-		assert_hotpath(data);
+		impl *data = get();
 		assert_hotpath(i < data->size);
 		return data->literals[i];
 	}
 
 	void get_literals(std::vector<literal> &v) const
 	{
+		impl *data = get();
 		for (unsigned int i = 0, n = data->size; i < n; ++i)
 			v.push_back(data->literals[i]);
 	}
 
 	operator bool() const
 	{
-		return data;
+		return ref;
 	}
 
 	std::string string() const
 	{
-		assert_hotpath(data);
+		impl *data = get();
 
 		std::ostringstream ss;
 
-		ss << "[" << data->thread << ":" << data->index << "]";
+		ss << "[" << data->index << "]";
 
 		for (unsigned int i = 0; i < data->size; ++i)
 			ss << " " << data->literals[i].string();
@@ -178,6 +164,8 @@ public:
 	}
 };
 
+const unsigned int clause::max_lbd;
+
 std::ostream &operator<<(std::ostream &os, const clause &c)
 {
 	return os << c.string();
@@ -19,55 +19,90 @@
 #ifndef SATXX11_CLAUSE_ALLOCATOR_HH
 #define SATXX11_CLAUSE_ALLOCATOR_HH
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <vector>
 
+extern "C" {
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
 #include <satxx11/assert_hotpath.hh>
+#include <satxx11/clause.hh>
+#include <satxx11/clause_arena.hh>
+#include <satxx11/literal.hh>
+#include <satxx11/system_error.hh>
 
 namespace satxx11 {
 
+/* Allocates clauses from this thread's slab of the clause arena and keeps
+ * track of how many threads still have each clause attached.
+ *
+ * Freed clauses leave holes in the slab, so every now and then (at restart)
+ * the solver compacts it: the live clauses are slid down towards the start
+ * of the slab and the memory at the end is given back to the kernel. This
+ * happens in three steps:
+ *
+ *  1. prepare_compact() works out where each live clause will end up,
+ *  2. the solver rewrites all its references to clauses using relocate(),
+ *  3. compact() moves the clauses themselves.
+ *
+ * This works because no other thread ever refers to the clauses in our
+ * slab; shared clauses are copied, and the original clauses live in the
+ * clause_store.
+ *
+ * If the slab starts filling up, the solver doesn't wait for the next
+ * restart but restarts, reduces, and compacts right away (see
+ * low_on_memory()). Only if that doesn't help do we run out of memory. */
 class clause_allocator {
 public:
+	/* Don't bother compacting less than this (in words). */
+	static const unsigned long min_compact_words = 1 << 18;
+
 	struct entry {
-		/* We pack a pointer + one bit into this member. Our pointers
-		 * are always aligned on at least a 4-byte boundary (probably
-		 * 8-byte, though), which means we can use the lower 2 (or 3)
-		 * bits for something else. We also rely on the fact that
-		 * sizeof(unsigned long) == sizeof(void *). */
-		unsigned long data;
+		/* The clause reference or, for a free entry, the index of
+		 * the next free entry. */
+		uint32_t data;
 
-		/* Number of threads with this clause attached */
-		unsigned int reference_count;
+		/* Number of threads with this clause attached (0 if the
+		 * entry is free) */
+		uint32_t reference_count;
 
 		entry()
 		{
 		}
 
 		entry(clause c, unsigned int reference_count):
-			data((unsigned long) c.data),
+			data(c.ref),
 			reference_count(reference_count)
 		{
 		}
 
 		bool is_free() const
 		{
-			return data & 1;
+			return !reference_count;
 		}
 
 		void free(unsigned int next)
 		{
-			data = (next << 1) + 1;
+			assert_hotpath(!reference_count);
+			data = next;
 		}
 
 		unsigned int next() const
 		{
 			assert_hotpath(is_free());
-			return data >> 1;
+			return data;
 		}
 
 		clause get_clause() const
 		{
 			assert_hotpath(!is_free());
-			return clause((clause::impl *) (data & ~1));
+			return clause(data);
 		}
 	};
 
@@ -77,22 +112,72 @@ public:
 	 * is no free entry. */
 	unsigned int first_free;
 
-	clause_allocator():
-		first_free(0)
+	/* Our slab of the arena; everything below top has been handed out
+	 * at some point. */
+	uint32_t begin;
+	uint32_t end;
+	uint32_t top;
+
+	/* Freed clauses, indexed by clause size. We simply reuse the space
+	 * of a freed clause for the next clause of the same size. */
+	std::vector<std::vector<uint32_t>> free_refs;
+
+	/* Number of words below top taken up by freed clauses */
+	unsigned long nr_free_words;
+
+	/* Where each live clause will be moved by compact(); indexed by the
+	 * entry index. Only valid between prepare_compact() and compact(). */
+	std::vector<uint32_t> forward;
+	uint32_t compact_top;
+
+	/* Once top reaches this, we're low on memory */
+	uint32_t pressure_top;
+
+	clause_allocator(unsigned int nr_threads, unsigned int thread):
+		first_free(0),
+		nr_free_words(0)
 	{
+		clause_arena::thread_slab(thread, begin, end);
+
+		top = begin;
+		update_pressure();
 	}
 
-	clause allocate(unsigned int nr_threads, unsigned int thread, bool learnt, const std::vector<literal> &v)
+	uint32_t allocate_words(unsigned int size)
 	{
+		if (size < free_refs.size() && !free_refs[size].empty()) {
+			uint32_t ref = free_refs[size].back();
+			free_refs[size].pop_back();
+
+			nr_free_words -= clause::nr_words(size);
+			return ref;
+		}
+
+		unsigned int nr_words = clause::nr_words(size);
+		if (end - top < nr_words)
+			throw system_error(ENOMEM);
+
+		uint32_t ref = top;
+		top += nr_words;
+		return ref;
+	}
+
+	clause allocate(bool learnt, const std::vector<literal> &v, unsigned int lbd = clause::max_lbd)
+	{
+		unsigned int size = v.size();
+		assert_hotpath(size >= 1);
+
 		unsigned int id = first_free;
-		clause c(thread, id, learnt, v);
+		uint32_t ref = allocate_words(size);
+		new (clause_arena::base + ref) clause::impl(id, learnt, size, v, lbd);
 
+		clause c(ref);
 		if (id == clauses.size()) {
 			++first_free;
-			clauses.push_back(entry(c, nr_threads));
+			clauses.push_back(entry(c, 1));
 		} else {
 			first_free = clauses[id].next();
-			clauses[id] = entry(c, nr_threads);
+			clauses[id] = entry(c, 1);
 		}
 
 		return c;
@@ -102,12 +187,118 @@ public:
 	{
 		entry &e = clauses[id];
 
+		clause c = e.get_clause();
 		if (--e.reference_count == 0) {
-			e.get_clause().free();
+			unsigned int size = c.size();
+			if (free_refs.size() <= size)
+				free_refs.resize(size + 1);
+			free_refs[size].push_back(c.ref);
+			nr_free_words += clause::nr_words(size);
+
 			e.free(first_free);
 			first_free = id;
 		}
 	}
+
+	bool is_live(clause c) const
+	{
+		const entry &e = clauses[c.index()];
+		return !e.is_free() && e.data == c.ref;
+	}
+
+	bool low_on_memory() const
+	{
+		return top >= pressure_top;
+	}
+
+	/* Called after every (attempted) compaction. We're low on memory
+	 * once the slab is three quarters full, or if we still are, once
+	 * half of what's left has been used up; this way, we don't keep
+	 * reducing and compacting if it doesn't help. */
+	void update_pressure()
+	{
+		uint32_t size = end - begin;
+		pressure_top = std::max(begin + size / 4 * 3, top + (end - top) / 2);
+	}
+
+	bool should_compact() const
+	{
+		if (low_on_memory())
+			return nr_free_words > 0;
+
+		return nr_free_words >= min_compact_words
+			&& 2 * nr_free_words >= top - begin;
+	}
+
+	void prepare_compact()
+	{
+		forward.resize(clauses.size());
+
+		/* The area between begin and top is completely covered by
+		 * clauses, live or freed, so we can walk it from one clause
+		 * header to the next. */
+		uint32_t to = begin;
+		for (uint32_t from = begin; from < top; ) {
+			clause c(from);
+			unsigned int nr_words = clause::nr_words(c.size());
+
+			if (is_live(c)) {
+				forward[c.index()] = to;
+				to += nr_words;
+			}
+
+			from += nr_words;
+		}
+
+		compact_top = to;
+	}
+
+	/* Returns the new location of a clause. */
+	clause relocate(clause c) const
+	{
+		if (c.ref < begin || c.ref >= top)
+			return c;
+
+		return clause(forward[c.index()]);
+	}
+
+	void compact()
+	{
+		for (uint32_t from = begin; from < top; ) {
+			clause c(from);
+			unsigned int nr_words = clause::nr_words(c.size());
+
+			if (is_live(c)) {
+				/* Clauses only ever move downwards, and we go
+				 * upwards, so we never overwrite a clause that
+				 * we haven't moved yet. */
+				uint32_t to = forward[c.index()];
+				clauses[c.index()].data = to;
+				memmove(clause_arena::base + to, clause_arena::base + from,
+					nr_words * sizeof(uint32_t));
+			}
+
+			from += nr_words;
+		}
+
+		/* The freed clauses are gone now. */
+		for (std::vector<uint32_t> &refs: free_refs)
+			refs.clear();
+
+		nr_free_words = 0;
+
+		/* Give the unused pages back to the kernel. */
+		unsigned long page_size = sysconf(_SC_PAGESIZE);
+		unsigned long first = ((unsigned long) (clause_arena::base + compact_top) + page_size - 1) & ~(page_size - 1);
+		unsigned long last = (unsigned long) (clause_arena::base + top);
+		if (first < last)
+			madvise((void *) first, last - first, MADV_DONTNEED);
+
+		top = compact_top;
+		std::vector<uint32_t>().swap(forward);
+
+		update_pressure();
+	}
 };
 
 }
@@ -0,0 +1,131 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_CLAUSE_ARENA_HH
+#define SATXX11_CLAUSE_ARENA_HH
+
+#include <cerrno>
+#include <cstdint>
+
+extern "C" {
+#include <sys/mman.h>
+}
+
+#include <satxx11/assert.hh>
+#include <satxx11/system_error.hh>
+
+namespace satxx11 {
+
+/* All clauses live in one big reservation of address space. A clause is
+ * referred to by its offset (in 32-bit words) from the start of the arena,
+ * which means that a clause reference only takes up 32 bits. The arena is
+ * divided into a slab for the original clauses (see clause_store) and one
+ * slab per thread; each thread allocates the clauses it owns from its own
+ * slab, so clauses that are learnt together also end up next to each other
+ * in memory.
+ *
+ * The reservation is made with MAP_NORESERVE, so only the pages that are
+ * actually used take up any memory. */
+class clause_arena {
+public:
+	/* 2^32 words is the most we can address with a 32-bit offset. */
+	static const unsigned long max_size = 1UL << 32;
+
+	/* Don't bother trying to run with less than this. */
+	static const unsigned long min_size = 1UL << 26;
+
+	static uint32_t *base;
+
+	/* In words */
+	static unsigned long size;
+
+	/* Slabs start on a page boundary (in words) */
+	static const unsigned long slab_alignment = 4096 / sizeof(uint32_t);
+
+	/* The clause_store's slab is [0, store_end); the threads share the
+	 * rest of the arena evenly. */
+	static uint32_t store_end;
+	static unsigned int nr_threads;
+	static unsigned long thread_slab_size;
+
+	/* Reserve the arena and divide it up. The clause_store gets
+	 * exactly store_size words (rounded up to a whole number of
+	 * pages), since we know how much space the original clauses take
+	 * up before we start. */
+	static void layout(unsigned int nr_threads, unsigned long store_size)
+	{
+		assert(!base);
+		assert(nr_threads >= 1);
+
+		/* The kernel may refuse to give us all of it (e.g.
+		 * because of ulimit -v), so try smaller sizes until
+		 * it works. */
+		for (size = max_size; size >= min_size; size /= 2) {
+			void *ptr = mmap(0, size * sizeof(uint32_t), PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (ptr != MAP_FAILED) {
+				base = (uint32_t *) ptr;
+				break;
+			}
+		}
+
+		if (!base)
+			throw system_error(ENOMEM);
+
+		store_size += slab_alignment - 1;
+		store_size -= store_size % slab_alignment;
+
+		/* The last page of the arena is left unused so that the
+		 * offsets (including end) fit in 32 bits. */
+		if (store_size + slab_alignment > size)
+			throw system_error(ENOMEM);
+
+		clause_arena::store_end = store_size;
+		clause_arena::nr_threads = nr_threads;
+
+		thread_slab_size = (size - slab_alignment - store_size) / nr_threads;
+		thread_slab_size -= thread_slab_size % slab_alignment;
+	}
+
+	static void store_slab(uint32_t &begin, uint32_t &end)
+	{
+		assert(base);
+
+		begin = 0;
+		end = store_end;
+	}
+
+	static void thread_slab(unsigned int i, uint32_t &begin, uint32_t &end)
+	{
+		assert(base);
+		assert(i < nr_threads);
+
+		begin = store_end + i * thread_slab_size;
+		end = begin + thread_slab_size;
+	}
+};
+
+uint32_t *clause_arena::base;
+unsigned long clause_arena::size;
+uint32_t clause_arena::store_end;
+unsigned int clause_arena::nr_threads;
+unsigned long clause_arena::thread_slab_size;
+
+}
+
+#endif
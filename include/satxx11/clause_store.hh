@@ -0,0 +1,128 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_CLAUSE_STORE_HH
+#define SATXX11_CLAUSE_STORE_HH
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+extern "C" {
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+#include <satxx11/assert.hh>
+#include <satxx11/binary_graph.hh>
+#include <satxx11/clause.hh>
+#include <satxx11/clause_arena.hh>
+#include <satxx11/cnf.hh>
+#include <satxx11/literal.hh>
+#include <satxx11/system_error.hh>
+#include <satxx11/ternary_graph.hh>
+
+namespace satxx11 {
+
+/* The original clauses of the instance. They are laid out one after another
+ * in their own slab of the clause arena before the solver threads start, and
+ * they never change or go away after that. This means that all threads can
+ * use the very same clauses without any reference counting; each thread only
+ * keeps its own watches for them.
+ *
+ * The index() of a clause in the store is its position in the store.
+ *
+ * The original binary and ternary clauses don't take up any space in the
+ * arena; they only exist in the shared binary_graph and ternary_graph. */
+class clause_store {
+public:
+	unsigned int nr_clauses;
+
+	uint32_t begin;
+	uint32_t end;
+	uint32_t top;
+
+	bool frozen;
+
+	binary_graph binaries;
+	ternary_graph ternaries;
+
+	clause_store(unsigned int nr_threads, unsigned int nr_variables, const cnf &clauses):
+		nr_clauses(0),
+		frozen(false),
+		binaries(nr_variables, clauses),
+		ternaries(nr_variables, clauses)
+	{
+		/* This is an upper bound, as not all clauses end up in
+		 * the store; offset 0 is the null clause. */
+		unsigned long nr_words = clause::nr_words(0)
+			+ clauses.size() * clause::nr_words(0) + clauses.nr_literals();
+		clause_arena::layout(nr_threads, nr_words);
+		clause_arena::store_slab(begin, end);
+
+		begin = clause::nr_words(0);
+		top = begin;
+	}
+
+	clause_store(const clause_store &) = delete;
+	clause_store &operator=(const clause_store &) = delete;
+
+	bool contains(clause c) const
+	{
+		return c.ref >= begin && c.ref < top;
+	}
+
+	clause add(const std::vector<literal> &v)
+	{
+		assert(!frozen);
+
+		unsigned int size = v.size();
+		assert(size >= 1);
+
+		unsigned int nr_words = clause::nr_words(size);
+		if (end - top < nr_words)
+			throw system_error(ENOMEM);
+
+		uint32_t ref = top;
+		top += nr_words;
+
+		new (clause_arena::base + ref) clause::impl(nr_clauses++, false, size, v, clause::max_lbd);
+		return clause(ref);
+	}
+
+	/* Called once all the original clauses have been added. From now on,
+	 * the store is read-only (and the kernel makes sure of it). */
+	void freeze()
+	{
+		frozen = true;
+
+		unsigned long page_size = sysconf(_SC_PAGESIZE);
+		unsigned long first = ((unsigned long) (clause_arena::base + begin) + page_size - 1) & ~(page_size - 1);
+		unsigned long last = ((unsigned long) (clause_arena::base + top) + page_size - 1) & ~(page_size - 1);
+		last = std::min(last, (unsigned long) (clause_arena::base + end) & ~(page_size - 1));
+
+		if (first < last && mprotect((void *) first, last - first, PROT_READ) == -1)
+			throw system_error(errno);
+	}
+};
+
+}
+
+#endif
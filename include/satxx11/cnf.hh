@@ -0,0 +1,139 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_CNF_HH
+#define SATXX11_CNF_HH
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <satxx11/assert_hotpath.hh>
+#include <satxx11/literal.hh>
+#include <satxx11/mapped_file.hh>
+
+namespace satxx11 {
+
+/* The original clauses of an instance, stored as one flat array of literals
+ * and an array of clause end offsets. This avoids one heap allocation per
+ * clause while reading the instance. */
+class cnf {
+public:
+	class span {
+	public:
+		const literal *first;
+		const literal *last;
+
+		span(const literal *first, const literal *last):
+			first(first),
+			last(last)
+		{
+		}
+
+		const literal *begin() const
+		{
+			return first;
+		}
+
+		const literal *end() const
+		{
+			return last;
+		}
+
+		unsigned int size() const
+		{
+			return last - first;
+		}
+
+		literal operator[](unsigned int i) const
+		{
+			assert_hotpath(first + i < last);
+			return first[i];
+		}
+	};
+
+	std::vector<literal> literals;
+
+	/* ends[i] is the index into literals one past the last literal of
+	 * clause i. Any literals after ends.back() belong to a clause that
+	 * hasn't been terminated yet. */
+	std::vector<uint64_t> ends;
+
+	/* Set if the instance was loaded from a binary CNF file. In that
+	 * case, the literals and clause end offsets are read directly from
+	 * the mapping and the vectors above are unused. */
+	std::unique_ptr<mapped_file> file;
+	const literal *mapped_literals;
+	const uint64_t *mapped_ends;
+	uint64_t nr_mapped_literals;
+	uint64_t nr_mapped_clauses;
+
+	cnf():
+		mapped_literals(0),
+		mapped_ends(0),
+		nr_mapped_literals(0),
+		nr_mapped_clauses(0)
+	{
+	}
+
+	const literal *literal_data() const
+	{
+		return file ? mapped_literals : literals.data();
+	}
+
+	const uint64_t *end_data() const
+	{
+		return file ? mapped_ends : ends.data();
+	}
+
+	uint64_t nr_literals() const
+	{
+		return file ? nr_mapped_literals : literals.size();
+	}
+
+	unsigned long size() const
+	{
+		return file ? nr_mapped_clauses : ends.size();
+	}
+
+	span operator[](unsigned long i) const
+	{
+		assert_hotpath(i < size());
+
+		const literal *l = literal_data();
+		const uint64_t *e = end_data();
+
+		uint64_t begin = i ? e[i - 1] : 0;
+		return span(l + begin, l + e[i]);
+	}
+
+	void push_back(literal lit)
+	{
+		literals.push_back(lit);
+	}
+
+	/* Terminate the current clause. */
+	void end_clause()
+	{
+		ends.push_back(literals.size());
+	}
+};
+
+}
+
+#endif
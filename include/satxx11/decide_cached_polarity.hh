@@ -21,7 +21,6 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <initializer_list>
 #include <vector>
 
 #include <satxx11/clause.hh>
@@ -29,17 +28,80 @@
 
 namespace satxx11 {
 
-template<class Decide>
+/* Phase saving: decide on the variable chosen by Decide, giving it the
+ * value that it had the last time it was assigned.
+ *
+ * On top of that, we remember the values of the longest conflict-free
+ * trail since the last rephasing (the "target" phases, which take
+ * precedence over the saved phases) and since the last time we went back
+ * to them (the "best" phases). Every so often, we rephase: we throw away
+ * the target phases and reset the saved phases to the best phases, to
+ * all false (the original phases), to all true, or to random values. The
+ * threads go through the rephasing schedule starting at different points,
+ * which makes them look at different parts of the search space.
+ *
+ * The schedule is short, so threads id and id + nr_schedule would start
+ * at the same point. To keep them apart, each group of nr_schedule
+ * threads rephases half an interval less often than the one before it,
+ * and all but the first group start out from random phases (from the
+ * thread's own random number generator). */
+template<class Decide, unsigned int rephase_interval = 1000>
 class decide_cached_polarity {
 public:
+	enum {
+		REPHASE_BEST,
+		REPHASE_ORIGINAL,
+		REPHASE_INVERTED,
+		REPHASE_RANDOM,
+	};
+
+	static const unsigned int nr_schedule = 6;
+
+	static unsigned int schedule(unsigned int i)
+	{
+		static const unsigned int s[nr_schedule] = {
+			REPHASE_BEST, REPHASE_ORIGINAL,
+			REPHASE_BEST, REPHASE_INVERTED,
+			REPHASE_BEST, REPHASE_RANDOM,
+		};
+
+		return s[i % nr_schedule];
+	}
+
 	Decide x;
+
+	/* Saved phases */
 	std::vector<bool> polarities;
 
+	/* 1 for true, -1 for false, 0 if not part of the trail */
+	std::vector<signed char> target;
+	unsigned int target_size;
+
+	std::vector<signed char> best;
+	unsigned int best_size;
+
+	unsigned long nr_conflicts;
+	unsigned long rephase_period;
+	unsigned long next_rephase;
+	unsigned int nr_rephases;
+
 	template<class Solver>
 	decide_cached_polarity(Solver &s):
 		x(s),
-		polarities(s.nr_variables)
+		polarities(s.nr_variables),
+		target(s.nr_variables, 0),
+		target_size(0),
+		best(s.nr_variables, 0),
+		best_size(0),
+		nr_conflicts(0),
+		rephase_period(rephase_interval + rephase_interval * (s.id / nr_schedule) / 2),
+		next_rephase(rephase_period),
+		nr_rephases(s.id)
 	{
+		if (s.id >= nr_schedule) {
+			for (unsigned int i = 0; i < s.nr_variables; ++i)
+				polarities[i] = s.random() & 1;
+		}
 	}
 
 	~decide_cached_polarity()
@@ -55,6 +117,7 @@ public:
 	template<class Solver>
 	void unassign(Solver &s, unsigned int variable)
 	{
+		polarities[variable] = s.value(variable);
 		x.unassign(s, variable);
 	}
 
@@ -64,8 +127,8 @@ public:
 		x.resolve(s, l);
 	}
 
-	template<class Solver>
-	void resolve(Solver &s, const std::vector<literal> &c)
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &c)
 	{
 		x.resolve(s, c);
 	}
@@ -82,19 +145,79 @@ public:
 		x.detach(c);
 	}
 
+	/* Save the values of the first n variables on the trail if that is
+	 * more than we saved last time. */
+	template<class Solver>
+	static void save(Solver &s, std::vector<signed char> &phases, unsigned int &size, unsigned int n)
+	{
+		if (n <= size)
+			return;
+
+		for (unsigned int i = 0; i < n; ++i) {
+			unsigned int var = s.stack.trail[i];
+			phases[var] = s.value(var) ? 1 : -1;
+		}
+
+		size = n;
+	}
+
+	template<class Solver>
+	void rephase(Solver &s)
+	{
+		switch (schedule(nr_rephases++)) {
+		case REPHASE_BEST:
+			for (unsigned int i = 0; i < s.nr_variables; ++i) {
+				if (best[i])
+					polarities[i] = best[i] > 0;
+			}
+
+			std::fill(best.begin(), best.end(), 0);
+			best_size = 0;
+			break;
+		case REPHASE_ORIGINAL:
+			std::fill(polarities.begin(), polarities.end(), false);
+			break;
+		case REPHASE_INVERTED:
+			std::fill(polarities.begin(), polarities.end(), true);
+			break;
+		case REPHASE_RANDOM:
+			for (unsigned int i = 0; i < s.nr_variables; ++i)
+				polarities[i] = s.random() & 1;
+			break;
+		}
+
+		std::fill(target.begin(), target.end(), 0);
+		target_size = 0;
+	}
+
 	template<class Solver>
 	void conflict(Solver &s)
 	{
 		x.conflict(s);
+
+		/* Everything before the current decision level was
+		 * conflict-free. */
+		unsigned int decision_index = s.stack.decision_index;
+		if (decision_index > 0) {
+			unsigned int n = s.stack.decisions[decision_index - 1];
+			save(s, target, target_size, n);
+			save(s, best, best_size, n);
+		}
+
+		if (++nr_conflicts == next_rephase) {
+			rephase(s);
+			next_rephase += rephase_period * (nr_rephases - s.id + 1);
+		}
 	}
 
 	template<class Solver>
 	literal operator()(Solver &s)
 	{
 		unsigned int var = x(s);
-		literal lit(var, polarities[var]);
-		polarities[var] = !polarities[var];
-		return lit;
+		if (target[var])
+			return literal(var, target[var] > 0);
+
+		return literal(var, polarities[var]);
 	}
 };
 
@@ -0,0 +1,172 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_DECIDE_LRB_HH
+#define SATXX11_DECIDE_LRB_HH
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <satxx11/activity_heap.hh>
+#include <satxx11/assert.hh>
+#include <satxx11/clause.hh>
+#include <satxx11/literal.hh>
+
+namespace satxx11 {
+
+/* Learning-rate branching: the score of a variable is an exponential
+ * moving average of its learning rate, i.e. the fraction of the
+ * conflicts that happened while it was assigned in which it took part
+ * (was seen during conflict analysis). The average is updated when the
+ * variable is unassigned.
+ *
+ * The step size of the moving average starts out at alpha_start/100 and
+ * is decreased by a millionth on every conflict until it reaches
+ * alpha_end/100.
+ *
+ * The scores of unassigned variables are also decayed by 5% for every
+ * conflict (the "locality" extension); we do this lazily for the
+ * variables at the top of the heap when making a decision. */
+template<unsigned int alpha_start = 40, unsigned int alpha_end = 6>
+class decide_lrb {
+public:
+	/* assigned[] of a variable that is not currently assigned */
+	static const uint64_t none = ~uint64_t(0);
+
+	activity_heap<> heap;
+
+	/* Indexed by variable */
+	std::vector<uint64_t> assigned;
+	std::vector<uint64_t> unassigned;
+	std::vector<unsigned int> participated;
+
+	uint64_t nr_conflicts;
+	float alpha;
+
+	template<class Solver>
+	decide_lrb(Solver &s):
+		heap(s.nr_variables),
+		assigned(s.nr_variables, uint64_t(none)),
+		unassigned(s.nr_variables, 0),
+		participated(s.nr_variables, 0),
+		nr_conflicts(0),
+		alpha(alpha_start / 100.)
+	{
+		/* Just a way to break ties between multiple threads */
+		for (unsigned int i = 0; i < 100; ++i) {
+			unsigned int var = s.random() % s.nr_variables;
+			heap.update(var, heap.activity(var) + 1e-6);
+		}
+	}
+
+	decide_lrb(const decide_lrb &) = delete;
+	decide_lrb &operator=(const decide_lrb &) = delete;
+
+	~decide_lrb()
+	{
+	}
+
+	template<class Solver>
+	void assign(Solver &s, unsigned int variable, bool value)
+	{
+		assert_hotpath(assigned[variable] == none);
+
+		assigned[variable] = nr_conflicts;
+		participated[variable] = 0;
+	}
+
+	template<class Solver>
+	void unassign(Solver &s, unsigned int variable)
+	{
+		/* The solver must have told us about the assignment */
+		assert_hotpath(assigned[variable] != none);
+
+		uint64_t interval = nr_conflicts - assigned[variable];
+		assigned[variable] = none;
+		if (interval > 0) {
+			float rate = float(participated[variable]) / interval;
+			heap.update(variable, (1 - alpha) * heap.activity(variable) + alpha * rate);
+		}
+
+		unassigned[variable] = nr_conflicts;
+		if (!heap.contains(variable))
+			heap.insert(variable);
+	}
+
+	template<class Solver>
+	void resolve(Solver &s, literal l)
+	{
+		++participated[l.variable()];
+	}
+
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
+	{
+	}
+
+	template<class ClauseType>
+	void attach(ClauseType c)
+	{
+	}
+
+	template<class ClauseType>
+	void detach(ClauseType c)
+	{
+	}
+
+	template<class Solver>
+	void conflict(Solver &s)
+	{
+		++nr_conflicts;
+
+		if (alpha > alpha_end / 100.)
+			alpha -= 1e-6;
+	}
+
+	template<class Solver>
+	unsigned int operator()(Solver &s)
+	{
+		debug_enter("");
+
+		unsigned int var;
+
+		while (true) {
+			assert(!heap.empty());
+			var = heap.top();
+			if (s.defined(var)) {
+				heap.pop();
+				continue;
+			}
+
+			uint64_t age = nr_conflicts - unassigned[var];
+			if (age == 0)
+				break;
+
+			heap.update(var, heap.activity(var) * powf(0.95, age));
+			unassigned[var] = nr_conflicts;
+		}
+
+		heap.pop();
+		return var;
+	}
+};
+
+}
+
+#endif
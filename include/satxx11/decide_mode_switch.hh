@@ -0,0 +1,129 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_DECIDE_MODE_SWITCH_HH
+#define SATXX11_DECIDE_MODE_SWITCH_HH
+
+#include <satxx11/clause.hh>
+#include <satxx11/literal.hh>
+
+namespace satxx11 {
+
+/* Alternate between a "focused" and a "stable" decision heuristic. Both
+ * heuristics see all the assignments and conflicts, so that either one
+ * is up to date when we switch to it; only the heuristic of the current
+ * mode is asked to decide.
+ *
+ * The first mode lasts for mode_interval conflicts, and each subsequent
+ * mode lasts mode_interval conflicts longer than the previous one. Odd
+ * threads start out in the stable mode. */
+template<class Focused, class Stable, unsigned int mode_interval = 1000>
+class decide_mode_switch {
+public:
+	Focused focused;
+	Stable stable;
+
+	bool is_stable;
+
+	unsigned long nr_conflicts;
+	unsigned long next_switch;
+	unsigned int nr_switches;
+
+	template<class Solver>
+	decide_mode_switch(Solver &s):
+		focused(s),
+		stable(s),
+		is_stable(s.id & 1),
+		nr_conflicts(0),
+		next_switch(mode_interval),
+		nr_switches(0)
+	{
+	}
+
+	~decide_mode_switch()
+	{
+	}
+
+	template<class Solver>
+	void assign(Solver &s, unsigned int variable, bool value)
+	{
+		focused.assign(s, variable, value);
+		stable.assign(s, variable, value);
+	}
+
+	template<class Solver>
+	void unassign(Solver &s, unsigned int variable)
+	{
+		focused.unassign(s, variable);
+		stable.unassign(s, variable);
+	}
+
+	template<class Solver>
+	void resolve(Solver &s, literal l)
+	{
+		focused.resolve(s, l);
+		stable.resolve(s, l);
+	}
+
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
+	{
+		focused.resolve(s, v);
+		stable.resolve(s, v);
+	}
+
+	template<class ClauseType>
+	void attach(ClauseType c)
+	{
+		focused.attach(c);
+		stable.attach(c);
+	}
+
+	template<class ClauseType>
+	void detach(ClauseType c)
+	{
+		focused.detach(c);
+		stable.detach(c);
+	}
+
+	template<class Solver>
+	void conflict(Solver &s)
+	{
+		focused.conflict(s);
+		stable.conflict(s);
+
+		if (++nr_conflicts == next_switch) {
+			is_stable = !is_stable;
+			++nr_switches;
+			next_switch += mode_interval * (nr_switches + 1);
+		}
+	}
+
+	template<class Solver>
+	unsigned int operator()(Solver &s)
+	{
+		if (is_stable)
+			return stable(s);
+
+		return focused(s);
+	}
+};
+
+}
+
+#endif
@@ -46,8 +46,8 @@ public:
 	{
 	}
 
-	template<class Solver>
-	void resolve(Solver &s, const std::vector<literal> &v)
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
 	{
 	}
 
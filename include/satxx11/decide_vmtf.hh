@@ -0,0 +1,225 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_DECIDE_VMTF_HH
+#define SATXX11_DECIDE_VMTF_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <satxx11/clause.hh>
+#include <satxx11/literal.hh>
+
+namespace satxx11 {
+
+/* Variable move-to-front: the variables are kept in a doubly-linked
+ * queue, and the variables that take part in a conflict are moved to the
+ * front of it. We always decide on the unassigned variable that is
+ * closest to the front.
+ *
+ * Each variable has a timestamp which increases towards the front of the
+ * queue. We cache a search position such that all the variables in front
+ * of it are assigned; unassigning a variable that is in front of it moves
+ * the search position forwards again.
+ *
+ * The variables are collected during conflict analysis and moved all at
+ * once, in the order of their old timestamps, so that their relative
+ * order is preserved. */
+class decide_vmtf {
+public:
+	static const unsigned int none = ~0U;
+
+	struct link {
+		unsigned int prev;
+		unsigned int next;
+	};
+
+	/* Indexed by variable */
+	std::vector<link> links;
+	std::vector<uint64_t> stamps;
+
+	/* The back (oldest) and front (most recently moved) of the queue */
+	unsigned int first;
+	unsigned int last;
+
+	unsigned int search;
+	uint64_t nr_stamps;
+
+	/* Variables to move to the front */
+	std::vector<unsigned int> bumped;
+
+	template<class Solver>
+	decide_vmtf(Solver &s):
+		links(s.nr_variables),
+		stamps(s.nr_variables),
+		first(none),
+		last(none),
+		search(none),
+		nr_stamps(0)
+	{
+		for (unsigned int i = 0; i < s.nr_variables; ++i)
+			enqueue(i);
+
+		/* Just a way to break ties between multiple threads */
+		for (unsigned int i = 0; i < 100; ++i)
+			move_to_front(s, s.random() % s.nr_variables);
+
+		search = last;
+	}
+
+	decide_vmtf(const decide_vmtf &) = delete;
+	decide_vmtf &operator=(const decide_vmtf &) = delete;
+
+	~decide_vmtf()
+	{
+	}
+
+	void enqueue(unsigned int var)
+	{
+		links[var].prev = last;
+		links[var].next = none;
+
+		if (last != none)
+			links[last].next = var;
+		else
+			first = var;
+
+		last = var;
+		stamps[var] = ++nr_stamps;
+	}
+
+	void dequeue(unsigned int var)
+	{
+		link &l = links[var];
+
+		if (l.prev != none)
+			links[l.prev].next = l.next;
+		else
+			first = l.next;
+
+		if (l.next != none)
+			links[l.next].prev = l.prev;
+		else
+			last = l.prev;
+	}
+
+	template<class Solver>
+	void move_to_front(Solver &s, unsigned int var)
+	{
+		if (var != last) {
+			dequeue(var);
+			enqueue(var);
+		}
+
+		if (!s.defined(var))
+			search = var;
+	}
+
+	struct stamp_compare {
+		const std::vector<uint64_t> &stamps;
+
+		stamp_compare(const std::vector<uint64_t> &stamps):
+			stamps(stamps)
+		{
+		}
+
+		bool operator()(unsigned int a, unsigned int b)
+		{
+			return stamps[a] < stamps[b];
+		}
+	};
+
+	template<class Solver>
+	void flush(Solver &s)
+	{
+		if (bumped.empty())
+			return;
+
+		std::sort(bumped.begin(), bumped.end(), stamp_compare(stamps));
+		bumped.erase(std::unique(bumped.begin(), bumped.end()), bumped.end());
+
+		for (unsigned int var: bumped)
+			move_to_front(s, var);
+
+		bumped.clear();
+	}
+
+	template<class Solver>
+	void assign(Solver &s, unsigned int variable, bool value)
+	{
+	}
+
+	template<class Solver>
+	void unassign(Solver &s, unsigned int variable)
+	{
+		if (stamps[variable] > stamps[search])
+			search = variable;
+	}
+
+	template<class Solver>
+	void resolve(Solver &s, literal l)
+	{
+		bumped.push_back(l.variable());
+	}
+
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
+	{
+	}
+
+	template<class ClauseType>
+	void attach(ClauseType c)
+	{
+	}
+
+	template<class ClauseType>
+	void detach(ClauseType c)
+	{
+	}
+
+	/* The solver calls us before analysing the conflict, so this takes
+	 * care of the variables from the previous conflict (if we haven't
+	 * made a decision since). */
+	template<class Solver>
+	void conflict(Solver &s)
+	{
+		flush(s);
+	}
+
+	template<class Solver>
+	unsigned int operator()(Solver &s)
+	{
+		debug_enter("");
+
+		flush(s);
+
+		unsigned int var = search;
+		while (s.defined(var)) {
+			var = links[var].prev;
+			assert(var != none);
+		}
+
+		search = var;
+		return var;
+	}
+};
+
+}
+
+#endif
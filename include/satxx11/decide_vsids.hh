@@ -40,148 +40,81 @@
 #ifndef SATXX11_DECIDE_VSIDS_HH
 #define SATXX11_DECIDE_VSIDS_HH
 
-#include <algorithm>
-#include <cstdint>
-#include <initializer_list>
+#include <cmath>
 #include <vector>
 
+#include <satxx11/activity_heap.hh>
 #include <satxx11/clause.hh>
 #include <satxx11/literal.hh>
 
 namespace satxx11 {
 
-template<unsigned int var_decay>
+/* The variables of the clauses involved in a conflict are not bumped
+ * right away; we add up the increments for each variable and apply them
+ * all at once at the next conflict or decision, so that every variable
+ * is moved in the heap at most once per conflict. */
+template<unsigned int var_decay, unsigned int arity = 4>
 class decide_vsids {
 public:
-	unsigned int size;
-	std::vector<unsigned int> heap;
+	/* Rescale activities once the increment is this large. */
+	static const int rescale_exponent = 64;
+
+	activity_heap<arity> heap;
+	float var_inc;
 
 	/* Indexed by variable */
-	std::vector<bool> contained;
-	std::vector<double> activities;
-	std::vector<unsigned int> positions;
+	std::vector<float> pending;
 
-	double var_inc;
+	/* Variables with a non-zero pending increment */
+	std::vector<unsigned int> bumped;
 
 	template<class Solver>
 	decide_vsids(Solver &s):
-		size(s.nr_variables),
 		heap(s.nr_variables),
-		contained(s.nr_variables),
-		activities(s.nr_variables),
-		positions(s.nr_variables),
-		var_inc(1)
+		var_inc(1),
+		pending(s.nr_variables, 0)
 	{
-		for (unsigned int i = 0; i < s.nr_variables; ++i) {
-			heap[i] = i;
-			contained[i] = true;
-			activities[i] = 0;
-			positions[i] = i;
-		}
-
 		/* Just a way to break ties between multiple threads */
 		for (unsigned int i = 0; i < 100; ++i)
 			bump(s.random() % s.nr_variables);
 	}
 
-	~decide_vsids()
-	{
-	}
-
-	unsigned int parent(unsigned int i)
-	{
-		return (i - 1) >> 1;
-	}
-
-	unsigned int left(unsigned int i)
-	{
-		return (i << 1) + 1;
-	}
+	decide_vsids(const decide_vsids &) = delete;
+	decide_vsids &operator=(const decide_vsids &) = delete;
 
-	unsigned int right(unsigned int i)
+	~decide_vsids()
 	{
-		return (i << 1) + 2;
 	}
 
-	void percolate_up(unsigned int i)
+	void bump(unsigned int var)
 	{
-		debug_enter("i = $", i);
-
-		unsigned int x = heap[i];
-		unsigned int p = parent(i);
-
-		while (i > 0 && activities[x] > activities[heap[p]]) {
-			heap[i] = heap[p];
-			positions[heap[p]] = i;
-			i = p;
-			p = parent(i);
-		}
+		debug_enter("variable = $", var);
 
-		heap[i] = x;
-		positions[x] = i;
+		heap.update(var, heap.activity(var) + var_inc);
+		if (!heap.contains(var))
+			heap.insert(var);
 	}
 
-	void percolate_down(unsigned int i)
+	void bump_later(literal lit)
 	{
-		debug_enter("i = $", i);
-
-		unsigned int n = size;
-
-		unsigned int x = heap[i];
-
-		while (true) {
-			unsigned int l = left(i);
-			if (l >= n)
-				break;
-
-			unsigned int child;
+		unsigned int var = lit.variable();
+		if (pending[var] == 0)
+			bumped.push_back(var);
 
-			unsigned int r = right(i);
-			if (r < n)
-				child = activities[heap[l]] < activities[heap[r]] ? r : l;
-			else
-				child = l;
-
-			if (activities[x] >= activities[heap[child]])
-				break;
-
-			heap[i] = heap[child];
-			positions[heap[i]] = i;
-			i = child;
-		}
-
-		heap[i] = x;
-		positions[x] = i;
+		pending[var] += var_inc;
 	}
 
-	void bump(unsigned int var)
+	void flush()
 	{
-		debug_enter("variable = $", var);
-
-		activities[var] += var_inc;
-		if (activities[var] > 1e100) {
-			for (unsigned int i = 0, n = activities.size(); i < n; ++i)
-				activities[i] *= 1e-100;
-
-			var_inc *= 1e-100;
-		}
-
-		if (contained[var]) {
-			percolate_up(positions[var]);
-		} else {
-			unsigned int i = size++;
-			heap[i] = var;
-
-			contained[var] = true;
-			positions[var] = i;
+		for (unsigned int var: bumped) {
+			heap.update(var, heap.activity(var) + pending[var]);
+			if (!heap.contains(var))
+				heap.insert(var);
 
-			percolate_up(i);
+			pending[var] = 0;
 		}
-	}
 
-	void bump(literal lit)
-	{
-		bump(lit.variable());
+		bumped.clear();
 	}
 
 	template<class Solver>
@@ -192,29 +125,21 @@ public:
 	template<class Solver>
 	void unassign(Solver &s, unsigned int variable)
 	{
-		if (contained[variable])
-			return;
-
-		unsigned int i = size++;
-		heap[i] = variable;
-
-		contained[variable] = true;
-		positions[variable] = i;
-
-		percolate_up(i);
+		if (!heap.contains(variable))
+			heap.insert(variable);
 	}
 
 	template<class Solver>
 	void resolve(Solver &s, literal l)
 	{
-		bump(l);
+		bump_later(l);
 	}
 
-	template<class Solver>
-	void resolve(Solver &s, const std::vector<literal> &v)
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
 	{
 		for (literal lit: v)
-			bump(lit);
+			bump_later(lit);
 	}
 
 	template<class ClauseType>
@@ -230,7 +155,17 @@ public:
 	template<class Solver>
 	void conflict(Solver &s)
 	{
+		flush();
+
 		var_inc *= 1 / (var_decay / 100.);
+
+		/* A single variable can be bumped several times per
+		 * conflict, and the activity may be a multiple of the
+		 * increment, but float has room for way more than that. */
+		if (var_inc > ldexpf(1, rescale_exponent)) {
+			heap.scale(-rescale_exponent);
+			var_inc = ldexpf(var_inc, -rescale_exponent);
+		}
 	}
 
 	template<class Solver>
@@ -238,16 +173,13 @@ public:
 	{
 		debug_enter("");
 
+		flush();
+
 		unsigned int var;
 
 		do {
-			assert(size > 0);
-
-			var = heap[0];
-			contained[var] = false;
-			heap[0] = heap[--size];
-			positions[heap[0]] = 0;
-			percolate_down(0);
+			assert(!heap.empty());
+			var = heap.pop();
 		} while (s.defined(var));
 
 		return var;
@@ -0,0 +1,288 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_DECOMPRESSOR_HH
+#define SATXX11_DECOMPRESSOR_HH
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/lzma.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+extern "C" {
+#include <unistd.h>
+}
+
+#include <satxx11/assert.hh>
+#include <satxx11/system_error.hh>
+
+namespace satxx11 {
+
+enum compression {
+	COMPRESSION_NONE,
+	COMPRESSION_GZIP,
+	COMPRESSION_BZIP2,
+	COMPRESSION_XZ,
+};
+
+static inline const char *compression_name(compression c)
+{
+	switch (c) {
+	case COMPRESSION_NONE:
+		return "none";
+	case COMPRESSION_GZIP:
+		return "gzip";
+	case COMPRESSION_BZIP2:
+		return "bzip2";
+	case COMPRESSION_XZ:
+		return "xz";
+	}
+
+	return "unknown";
+}
+
+/* Guess the compression format from the first few bytes of a file. We look
+ * at the magic numbers rather than the file name so that compressed data
+ * on standard input works too. */
+static inline compression detect_compression(const char *data, unsigned long size)
+{
+	if (size >= 2 && !memcmp(data, "\x1f\x8b", 2))
+		return COMPRESSION_GZIP;
+	if (size >= 3 && !memcmp(data, "BZh", 3))
+		return COMPRESSION_BZIP2;
+	if (size >= 6 && !memcmp(data, "\xfd" "7zXZ\0", 6))
+		return COMPRESSION_XZ;
+
+	return COMPRESSION_NONE;
+}
+
+/* A boost::iostreams source that first returns some data which has already
+ * been read from the file descriptor (e.g. to look for a magic number) and
+ * then continues reading from the file descriptor itself. */
+class prefixed_fd_source {
+public:
+	typedef char char_type;
+	typedef boost::iostreams::source_tag category;
+
+	int fd;
+	std::vector<char> prefix;
+	unsigned long prefix_index;
+
+	prefixed_fd_source(int fd, const char *data, unsigned long size):
+		fd(fd),
+		prefix(data, data + size),
+		prefix_index(0)
+	{
+	}
+
+	std::streamsize read(char *s, std::streamsize n)
+	{
+		if (prefix_index < prefix.size()) {
+			unsigned long len = std::min<unsigned long>(n, prefix.size() - prefix_index);
+			memcpy(s, &prefix[prefix_index], len);
+			prefix_index += len;
+			return len;
+		}
+
+		while (true) {
+			ssize_t len = ::read(fd, s, n);
+			if (len == -1) {
+				if (errno == EINTR)
+					continue;
+
+				throw system_error(errno);
+			}
+
+			return len ? len : -1;
+		}
+	}
+};
+
+/* Decompresses a stream on a separate thread and hands the decompressed
+ * data over in large blocks. This way, the decompression overlaps with
+ * whatever the reading thread does with the data (i.e. parsing). */
+class decompressor {
+public:
+	static const unsigned int nr_blocks = 4;
+	static const unsigned long block_size = 4 << 20;
+
+	/* Size of the internal buffers of the decompression filters. The
+	 * default (4 KiB) nearly halves the decompression speed. */
+	static const unsigned long buffer_size = 1 << 20;
+
+	struct block {
+		std::vector<char> data;
+		unsigned long size;
+	};
+
+	boost::iostreams::filtering_istream in;
+
+	block blocks[nr_blocks];
+
+	/* Blocks are filled in round-robin order; these count the number
+	 * of blocks that have been filled and released, respectively. */
+	unsigned long nr_produced;
+	unsigned long nr_consumed;
+
+	/* True if the reader is still using the oldest filled block. */
+	bool holding;
+	bool eof;
+	std::exception_ptr error;
+
+	std::mutex mutex;
+	std::condition_variable produced;
+	std::condition_variable consumed;
+
+	std::thread thread;
+
+	template<class Source>
+	decompressor(compression c, const Source &source):
+		nr_produced(0),
+		nr_consumed(0),
+		holding(false),
+		eof(false)
+	{
+		using namespace boost::iostreams;
+
+		switch (c) {
+		case COMPRESSION_GZIP:
+			in.push(gzip_decompressor(zlib::default_window_bits, buffer_size), buffer_size);
+			break;
+		case COMPRESSION_BZIP2:
+			in.push(bzip2_decompressor(bzip2::default_small, buffer_size), buffer_size);
+			break;
+		case COMPRESSION_XZ:
+			in.push(lzma_decompressor(buffer_size), buffer_size);
+			break;
+		default:
+			assert(false);
+		}
+
+		in.push(source, buffer_size);
+
+		/* Otherwise, decompression errors would just look like the
+		 * end of the stream. */
+		in.exceptions(std::ios::badbit);
+
+		for (unsigned int i = 0; i < nr_blocks; ++i)
+			blocks[i].data.resize(block_size);
+
+		thread = std::thread(&decompressor::run, this);
+	}
+
+	decompressor(const decompressor &) = delete;
+	decompressor &operator=(const decompressor &) = delete;
+
+	~decompressor()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			/* Make the thread exit early if we didn't read
+			 * everything (e.g. because of a parse error). */
+			eof = true;
+		}
+
+		consumed.notify_one();
+		thread.join();
+	}
+
+	void run()
+	{
+		try {
+			while (true) {
+				block *b;
+
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					while (!eof && nr_produced - nr_consumed == nr_blocks)
+						consumed.wait(lock);
+
+					if (eof)
+						return;
+
+					b = &blocks[nr_produced % nr_blocks];
+				}
+
+				/* Decompress without holding the lock. */
+				in.read(&b->data[0], block_size);
+				b->size = in.gcount();
+
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					if (b->size)
+						++nr_produced;
+					else
+						eof = true;
+				}
+
+				produced.notify_one();
+
+				if (!b->size)
+					return;
+			}
+		} catch (...) {
+			std::unique_lock<std::mutex> lock(mutex);
+			error = std::current_exception();
+			eof = true;
+			produced.notify_one();
+		}
+	}
+
+	/* Get the next block of decompressed data. The previous block that
+	 * was returned is no longer valid after this. Returns false at the
+	 * end of the stream. */
+	bool read(const char *&data, unsigned long &size)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (holding) {
+			/* Release the previous block. */
+			holding = false;
+			++nr_consumed;
+			consumed.notify_one();
+		}
+
+		while (nr_consumed == nr_produced && !eof)
+			produced.wait(lock);
+
+		if (error)
+			std::rethrow_exception(error);
+
+		if (nr_consumed == nr_produced)
+			return false;
+
+		block &b = blocks[nr_consumed % nr_blocks];
+		holding = true;
+		data = &b.data[0];
+		size = b.size;
+		return true;
+	}
+};
+
+}
+
+#endif
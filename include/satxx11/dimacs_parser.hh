@@ -0,0 +1,519 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_DIMACS_PARSER_HH
+#define SATXX11_DIMACS_PARSER_HH
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <unistd.h>
+}
+
+#include <satxx11/cnf.hh>
+#include <satxx11/decompressor.hh>
+#include <satxx11/format.hh>
+#include <satxx11/literal.hh>
+#include <satxx11/mapped_file.hh>
+#include <satxx11/system_error.hh>
+#include <satxx11/variable_remap.hh>
+
+namespace satxx11 {
+
+/* A DIMACS CNF tokenizer which works directly on (memory-mapped) input
+ * buffers. Literals are written straight into a flat clause list, so there
+ * is no allocation per line or per clause. Compressed input is decompressed
+ * on a separate thread while we parse. */
+class dimacs_parser {
+public:
+	/* Largest variable number that we can represent in a literal. */
+	static const unsigned long max_variable = (1UL << 31) - 1;
+
+	/* May be NULL, in which case the literals keep the variable numbers
+	 * of the input. */
+	variable_remap *variables;
+	cnf &clauses;
+
+	/* Values from the problem line, if any. */
+	unsigned long nr_header_variables;
+	unsigned long nr_header_clauses;
+
+	/* Size of the whole input, if we know it in advance (0 otherwise) */
+	unsigned long input_size;
+
+	unsigned long nr_bytes;
+	unsigned long nr_lines;
+
+	/* Set when we see the SATLIB end-of-instance marker ("%"); anything
+	 * after it is ignored. */
+	bool finished;
+
+	compression input_compression;
+
+	/* See parse_block() */
+	std::vector<char> partial_line;
+
+	dimacs_parser(variable_remap *variables, cnf &clauses):
+		variables(variables),
+		clauses(clauses),
+		nr_header_variables(0),
+		nr_header_clauses(0),
+		input_size(0),
+		nr_bytes(0),
+		nr_lines(0),
+		finished(false),
+		input_compression(COMPRESSION_NONE)
+	{
+	}
+
+	__attribute__ ((noreturn))
+	void error(const char *message)
+	{
+		throw std::runtime_error(format("Parse error on line $: $", nr_lines + 1, message));
+	}
+
+	static bool is_blank(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	static bool is_digit(char c)
+	{
+		return (unsigned char) (c - '0') < 10;
+	}
+
+	static const char *skip_blanks(const char *p, const char *end)
+	{
+		while (p != end && is_blank(*p))
+			++p;
+
+		return p;
+	}
+
+	/* Returns a pointer to the beginning of the next line. */
+	const char *skip_line(const char *p, const char *end)
+	{
+		const char *nl = (const char *) memchr(p, '\n', end - p);
+		if (!nl)
+			return end;
+
+		++nr_lines;
+		return nl + 1;
+	}
+
+	unsigned long parse_unsigned(const char *&p, const char *end)
+	{
+		if (p == end || !is_digit(*p))
+			error("expected a number");
+
+		unsigned long x = 0;
+		do {
+			x = 10 * x + (*p++ - '0');
+			if (x > max_variable)
+				error("number too large");
+		} while (p != end && is_digit(*p));
+
+		return x;
+	}
+
+	const char *parse_problem_line(const char *p, const char *end)
+	{
+		p = skip_blanks(p + 1, end);
+		if (end - p < 3 || memcmp(p, "cnf", 3))
+			error("expected \"p cnf\"");
+
+		p = skip_blanks(p + 3, end);
+		nr_header_variables = parse_unsigned(p, end);
+		p = skip_blanks(p, end);
+		nr_header_clauses = parse_unsigned(p, end);
+
+		/* Don't let the problem line alone make us allocate memory:
+		 * each variable and each clause takes at least two bytes of
+		 * input. If we don't know the size of the input, we go by what
+		 * we have of it so far. Beyond that, the arrays grow on
+		 * demand. */
+		unsigned long max_reserve = (input_size ? input_size : end - p) / 2;
+		if (variables)
+			variables->reserve(std::min(nr_header_variables, max_reserve));
+		clauses.ends.reserve(clauses.size() + std::min(nr_header_clauses, max_reserve));
+		return skip_line(p, end);
+	}
+
+	/* Parse a block of input. The block must end at a line boundary (or
+	 * at the end of the input), but a clause may span several lines and
+	 * thus several blocks. */
+	void parse(const char *p, const char *end)
+	{
+		nr_bytes += end - p;
+
+		while (p != end && !finished) {
+			/* We're at the beginning of a line. */
+			p = skip_blanks(p, end);
+			if (p == end)
+				break;
+
+			switch (*p) {
+			case '\n':
+				++nr_lines;
+				++p;
+				continue;
+			case 'c':
+				p = skip_line(p, end);
+				continue;
+			case 'p':
+				p = parse_problem_line(p, end);
+				continue;
+			case 'x':
+				error("cannot read XOR clauses");
+			case '%':
+				finished = true;
+				continue;
+			}
+
+			/* Literals until the end of the line. */
+			while (true) {
+				p = skip_blanks(p, end);
+				if (p == end)
+					break;
+
+				if (*p == '\n') {
+					++nr_lines;
+					++p;
+					break;
+				}
+
+				bool negative = false;
+				if (*p == '-') {
+					negative = true;
+					++p;
+				}
+
+				unsigned long x = parse_unsigned(p, end);
+				if (p != end && !is_blank(*p) && *p != '\n')
+					error("unexpected character");
+
+				if (x == 0) {
+					clauses.end_clause();
+					continue;
+				}
+
+				clauses.push_back(literal(variables ? (*variables)(x) : x, !negative));
+			}
+		}
+	}
+
+	/* Parse the comments and the problem line at the beginning of the
+	 * input. Returns a pointer to the first line that isn't one of those. */
+	const char *parse_prologue(const char *p, const char *end)
+	{
+		const char *start = p;
+
+		while (p != end) {
+			const char *q = skip_blanks(p, end);
+			if (q == end) {
+				p = q;
+				break;
+			}
+
+			if (*q == '\n') {
+				++nr_lines;
+				p = q + 1;
+			} else if (*q == 'c') {
+				p = skip_line(q, end);
+			} else if (*q == 'p') {
+				p = parse_problem_line(q, end);
+			} else {
+				break;
+			}
+		}
+
+		nr_bytes += p - start;
+		return p;
+	}
+
+	/* Parse a (memory-mapped) buffer using several threads. The buffer is
+	 * split at line boundaries and each chunk is tokenized into its own
+	 * clause list, keeping the variable numbers of the input. The chunks
+	 * are then merged in order: the variables are added to the real
+	 * variable numbering in their order of first appearance, so the end
+	 * result is exactly the same as if we had parsed the buffer from start
+	 * to end. A clause which spans two chunks simply continues in the
+	 * next chunk, since the clause ends are offsets into the literals. */
+	void parse_parallel(const char *data, unsigned long size, unsigned int nr_threads)
+	{
+		/* Don't bother with threads for small inputs. */
+		static const unsigned long min_chunk_size = 1 << 20;
+
+		const char *end = data + size;
+		const char *p = parse_prologue(data, end);
+
+		unsigned long nr_chunks = std::min<unsigned long>(nr_threads, (end - p) / min_chunk_size);
+		if (nr_chunks <= 1) {
+			parse(p, end);
+			return;
+		}
+
+		struct chunk {
+			const char *begin;
+			const char *end;
+
+			cnf clauses;
+
+			unsigned long nr_lines;
+			bool finished;
+			std::exception_ptr error;
+
+			uint64_t literals_offset;
+			uint64_t ends_offset;
+		};
+
+		std::vector<chunk> chunks(nr_chunks);
+		for (unsigned long i = 0; i < nr_chunks; ++i) {
+			chunk &c = chunks[i];
+
+			c.begin = i ? chunks[i - 1].end : p;
+			c.end = end;
+			if (i + 1 < nr_chunks) {
+				const char *split = p + (end - p) * (i + 1) / nr_chunks;
+				if (split < c.begin)
+					split = c.begin;
+
+				const char *nl = (const char *) memchr(split, '\n', end - split);
+				if (nl)
+					c.end = nl + 1;
+			}
+		}
+
+		auto tokenize = [this](chunk *c) {
+			dimacs_parser parser(NULL, c->clauses);
+
+			try {
+				parser.parse(c->begin, c->end);
+			} catch (...) {
+				c->error = std::current_exception();
+			}
+
+			c->nr_lines = parser.nr_lines;
+			c->finished = parser.finished;
+		};
+
+		{
+			std::vector<std::thread> threads;
+			for (unsigned long i = 1; i < nr_chunks; ++i)
+				threads.push_back(std::thread(tokenize, &chunks[i]));
+
+			tokenize(&chunks[0]);
+
+			for (std::thread &t: threads)
+				t.join();
+		}
+
+		/* Anything after the end-of-instance marker is ignored (it
+		 * might even contain things that don't parse). */
+		unsigned long nr_used = nr_chunks;
+		for (unsigned long i = 0; i < nr_chunks; ++i) {
+			if (chunks[i].finished) {
+				nr_used = i + 1;
+				break;
+			}
+		}
+
+		for (unsigned long i = 0; i < nr_used; ++i) {
+			if (chunks[i].error) {
+				/* Parse everything again to get the right line
+				 * number in the error message. */
+				parse(p, end);
+				std::rethrow_exception(chunks[i].error);
+			}
+		}
+
+		/* Number the variables (in order!) and work out where each
+		 * chunk goes in the final clause list. */
+		uint64_t nr_literals = clauses.literals.size();
+		uint64_t nr_clauses = clauses.ends.size();
+
+		for (unsigned long i = 0; i < nr_used; ++i) {
+			chunk &c = chunks[i];
+
+			for (literal lit: c.clauses.literals)
+				(*variables)(lit.variable());
+
+			c.literals_offset = nr_literals;
+			c.ends_offset = nr_clauses;
+			nr_literals += c.clauses.literals.size();
+			nr_clauses += c.clauses.ends.size();
+
+			nr_bytes += c.end - c.begin;
+			nr_lines += c.nr_lines;
+		}
+
+		clauses.literals.resize(nr_literals);
+		clauses.ends.resize(nr_clauses);
+
+		auto copy = [this](chunk *c) {
+			literal *l = &clauses.literals[c->literals_offset];
+			for (literal lit: c->clauses.literals)
+				*l++ = literal(variables->find(lit.variable()), lit.value());
+
+			uint64_t *e = &clauses.ends[c->ends_offset];
+			for (uint64_t x: c->clauses.ends)
+				*e++ = c->literals_offset + x;
+
+			/* Free the memory as soon as possible */
+			std::vector<literal>().swap(c->clauses.literals);
+			std::vector<uint64_t>().swap(c->clauses.ends);
+		};
+
+		{
+			std::vector<std::thread> threads;
+			for (unsigned long i = 1; i < nr_used; ++i)
+				threads.push_back(std::thread(copy, &chunks[i]));
+
+			copy(&chunks[0]);
+
+			for (std::thread &t: threads)
+				t.join();
+		}
+
+		finished = nr_used < nr_chunks || chunks[nr_used - 1].finished;
+	}
+
+	/* Parse a block of input which may end in the middle of a line. The
+	 * incomplete last line is saved and parsed together with the next
+	 * block. */
+	void parse_block(const char *p, const char *end)
+	{
+		const char *nl = (const char *) memrchr(p, '\n', end - p);
+		if (!nl) {
+			partial_line.insert(partial_line.end(), p, end);
+			return;
+		}
+
+		if (!partial_line.empty()) {
+			const char *first_nl = (const char *) memchr(p, '\n', end - p);
+			partial_line.insert(partial_line.end(), p, first_nl + 1);
+			parse(&partial_line[0], &partial_line[0] + partial_line.size());
+			partial_line.clear();
+			p = first_nl + 1;
+		}
+
+		parse(p, nl + 1);
+		partial_line.assign(nl + 1, end);
+	}
+
+	/* Parse whatever is left over from parse_block() and terminate a
+	 * clause that is missing its final 0. */
+	void finish()
+	{
+		if (!partial_line.empty()) {
+			parse(&partial_line[0], &partial_line[0] + partial_line.size());
+			partial_line.clear();
+		}
+
+		uint64_t last = clauses.ends.empty() ? 0 : clauses.ends.back();
+		if (clauses.literals.size() != last)
+			clauses.end_clause();
+	}
+
+	void parse_decompressor(decompressor &d)
+	{
+		const char *data;
+		unsigned long size;
+		while (d.read(data, size))
+			parse_block(data, data + size);
+
+		finish();
+	}
+
+	/* Parse a whole (memory-mapped) file. Uncompressed files are parsed
+	 * using up to nr_threads threads. */
+	void parse_mapped(const char *data, unsigned long size, unsigned int nr_threads = 1)
+	{
+		input_compression = detect_compression(data, size);
+		if (input_compression == COMPRESSION_NONE) {
+			input_size = size;
+			parse_parallel(data, size, nr_threads);
+			finish();
+		} else {
+			decompressor d(input_compression,
+				boost::iostreams::array_source(data, size));
+			parse_decompressor(d);
+		}
+	}
+
+	/* Parse a file that cannot be mapped (e.g. a pipe). */
+	void parse_stream(int fd)
+	{
+		/* Read the file in blocks. We need the first few bytes to
+		 * check for compression. */
+		std::vector<char> buffer(1 << 20);
+		unsigned long size = 0;
+
+		while (size < 6) {
+			ssize_t n = read(fd, &buffer[size], buffer.size() - size);
+			if (n == -1) {
+				if (errno == EINTR)
+					continue;
+
+				throw system_error(errno);
+			}
+
+			if (n == 0)
+				break;
+
+			size += n;
+		}
+
+		input_compression = detect_compression(&buffer[0], size);
+		if (input_compression != COMPRESSION_NONE) {
+			decompressor d(input_compression,
+				prefixed_fd_source(fd, &buffer[0], size));
+			parse_decompressor(d);
+			return;
+		}
+
+		while (size) {
+			parse_block(&buffer[0], &buffer[0] + size);
+
+			while (true) {
+				ssize_t n = read(fd, &buffer[0], buffer.size());
+				if (n == -1) {
+					if (errno == EINTR)
+						continue;
+
+					throw system_error(errno);
+				}
+
+				size = n;
+				break;
+			}
+		}
+
+		finish();
+	}
+};
+
+}
+
+#endif
@@ -21,6 +21,8 @@
 
 #include <algorithm>
 
+#include <satxx11/assert.hh>
+
 namespace satxx11 {
 
 #if 0
@@ -32,10 +34,17 @@ Iterator erase(Iterator first, Iterator last, const T &value)
 }
 #endif
 
+/* Remove one occurrence of value (which must be there) from an unordered
+ * container. There may be more than one, e.g. if the same clause was
+ * learnt by two threads. */
 template<class Container, typename T>
 void erase(Container &container, const T &value)
 {
-	container.erase(std::remove(container.begin(), container.end(), value));
+	auto it = std::find(container.begin(), container.end(), value);
+	assert(it != container.end());
+
+	*it = container.back();
+	container.pop_back();
 }
 
 }
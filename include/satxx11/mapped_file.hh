@@ -0,0 +1,81 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_MAPPED_FILE_HH
+#define SATXX11_MAPPED_FILE_HH
+
+#include <cerrno>
+
+extern "C" {
+#include <sys/mman.h>
+#include <sys/stat.h>
+}
+
+#include <satxx11/system_error.hh>
+
+namespace satxx11 {
+
+/* A read-only memory mapping of a whole file. If the file descriptor does
+ * not refer to something that can be mapped (e.g. a pipe), data is 0 and
+ * the caller is expected to fall back to reading the file normally. */
+class mapped_file {
+public:
+	const char *data;
+	unsigned long size;
+
+	explicit mapped_file(int fd):
+		data(0),
+		size(0)
+	{
+		struct stat st;
+		if (fstat(fd, &st) == -1)
+			throw system_error(errno);
+
+		if (!S_ISREG(st.st_mode) || st.st_size == 0)
+			return;
+
+		void *ptr = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr == MAP_FAILED)
+			throw system_error(errno);
+
+		/* We only ever scan the file from the beginning to the end,
+		 * so tell the kernel to read ahead aggressively. */
+		madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+
+		data = (const char *) ptr;
+		size = st.st_size;
+	}
+
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	~mapped_file()
+	{
+		if (data)
+			munmap((void *) data, size);
+	}
+
+	operator bool() const
+	{
+		return data;
+	}
+};
+
+}
+
+#endif
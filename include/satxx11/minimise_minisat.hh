@@ -19,7 +19,6 @@
 #ifndef SATXX11_MINIMISE_MINISAT_HH
 #define SATXX11_MINIMISE_MINISAT_HH
 
-#include <stack>
 #include <vector>
 
 #include <satxx11/debug.hh>
@@ -28,10 +27,41 @@
 
 namespace satxx11 {
 
-/* Recursive minimisation as done in Minisat 2.2.0. */
+/* Recursive minimisation as done in Minisat 2.2.0, but with the results of
+ * the redundancy checks remembered for the rest of the conflict: a variable
+ * that was found to be implied by the learnt clause is "removable", and one
+ * that was found to depend on something outside it is "poison". That way,
+ * every variable is expanded at most once per conflict. */
 class minimise_minisat {
 public:
-	minimise_minisat()
+	enum {
+		UNMARKED,
+		REMOVABLE,
+		POISON,
+	};
+
+	/* Depth-first search state: a variable and the index of the next
+	 * literal of its reason to look at. */
+	struct frame {
+		unsigned int variable;
+		unsigned int index;
+
+		frame(unsigned int variable, unsigned int index):
+			variable(variable),
+			index(index)
+		{
+		}
+	};
+
+	/* All UNMARKED between conflicts; cleanup lists the variables we
+	 * have to reset. */
+	std::vector<unsigned char> marks;
+	std::vector<unsigned int> cleanup;
+	std::vector<frame> agenda;
+
+	template<class Solver>
+	minimise_minisat(Solver &s):
+		marks(s.nr_variables, UNMARKED)
 	{
 	}
 
@@ -40,42 +70,61 @@ public:
 		return 1UL << (level & 63);
 	}
 
+	void mark(unsigned int var, unsigned char m)
+	{
+		if (marks[var] == UNMARKED)
+			cleanup.push_back(var);
+
+		marks[var] = m;
+	}
+
 	template<class Solver>
-	bool redundant(Solver &s, std::vector<bool> &seen, literal lit, uint64_t abstract_levels)
+	bool redundant(Solver &s, const std::vector<bool> &seen, literal lit, uint64_t abstract_levels)
 	{
 		debug_enter("");
 
-		std::stack<unsigned int> agenda;
-		agenda.push(lit.variable());
+		agenda.clear();
+		agenda.push_back(frame(lit.variable(), 0));
 
 		while (!agenda.empty()) {
-			unsigned int var = agenda.top();
-			agenda.pop();
-
-			std::vector<literal> reason;
+			unsigned int var = agenda.back().variable;
 
-			assert_hotpath(s.reasons[var]);
-			s.reasons[var].get_literals(reason);
+			assert_hotpath(s.state[var].reason);
+			auto reason = s.state[var].reason.literals(literal(var, s.value(var)));
 
-			for (literal lit: reason) {
-				unsigned int var = lit.variable();
+			unsigned int i = agenda.back().index++;
+			if (reason.begin() + i == reason.end()) {
+				/* Everything that var depends on is either
+				 * in the clause or removable itself. */
+				agenda.pop_back();
+				if (!agenda.empty())
+					mark(var, REMOVABLE);
 
-				if (seen[var])
-					continue;
-
-				seen[var] = 1;
-
-				if (s.stack.levels[var] == 0)
-					continue;
-
-				if (!s.reasons[var])
-					return false;
-
-				if (!(abstract_levels & level_to_abstract_level(s.stack.levels[var])))
-					return false;
+				continue;
+			}
 
-				agenda.push(var);
+			unsigned int other = reason.begin()[i].variable();
+			if (other == var || seen[other] || marks[other] == REMOVABLE)
+				continue;
+
+			if (s.state[other].level == 0)
+				continue;
+
+			if (marks[other] == POISON || !s.state[other].reason
+				|| !(abstract_levels & level_to_abstract_level(s.state[other].level)))
+			{
+				/* The variables on the stack all depend on
+				 * other; none of them can be removed. (The
+				 * candidate itself is in the clause, so it
+				 * doesn't need a mark.) */
+				mark(other, POISON);
+				for (unsigned int j = 1; j < agenda.size(); ++j)
+					mark(agenda[j].variable, POISON);
+
+				return false;
 			}
+
+			agenda.push_back(frame(other, 0));
 		}
 
 		/* “If search always ends at marked literals then the candidate
@@ -90,21 +139,21 @@ public:
 
 		uint64_t abstract_levels = 0;
 		for (literal lit: learnt_clause)
-			abstract_levels |= level_to_abstract_level(s.stack.levels[lit.variable()]);
+			abstract_levels |= level_to_abstract_level(s.state[lit.variable()].level);
 
-		std::vector<literal> result;
+		unsigned int j = 0;
 		for (literal lit: learnt_clause) {
-			if (s.reasons[lit.variable()]) {
-				/* XXX: This copy may be expensive. */
-				std::vector<bool> seen_copy = seen;
-				if (redundant(s, seen_copy, lit, abstract_levels))
-					continue;
-			}
+			if (s.state[lit.variable()].reason && redundant(s, seen, lit, abstract_levels))
+				continue;
 
-			result.push_back(lit);
+			learnt_clause[j++] = lit;
 		}
 
-		learnt_clause = result;
+		learnt_clause.resize(j);
+
+		for (unsigned int var: cleanup)
+			marks[var] = UNMARKED;
+		cleanup.clear();
 	}
 };
 
@@ -23,7 +23,8 @@ namespace satxx11 {
 
 class minimise_noop {
 public:
-	minimise_noop()
+	template<class Solver>
+	minimise_noop(Solver &s)
 	{
 	}
 
@@ -81,6 +81,20 @@ public:
 	{
 	}
 
+	/* Called by tiered clause database reductions with the number of
+	 * learnt clauses in each tier afterwards. */
+	template<class Solver>
+	void reduce(Solver &s, unsigned int nr_core, unsigned int nr_tier2, unsigned int nr_local)
+	{
+	}
+
+	/* Called by clause database reductions with the time (in seconds)
+	 * that the reduction took. */
+	template<class Solver>
+	void reduce_time(Solver &s, double seconds)
+	{
+	}
+
 	template<class Solver>
 	void sat(Solver &s)
 	{
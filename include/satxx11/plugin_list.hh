@@ -124,20 +124,20 @@ public:
 		attach(s, plugins, c);
 	}
 
-	template<class Solver, unsigned int I = 0, typename... Args>
-	typename std::enable_if<I == sizeof...(Args), void>::type detach(Solver &s, std::tuple<Args...> &args, clause c)
+	template<class Solver, class ClauseType, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I == sizeof...(Args), void>::type detach(Solver &s, std::tuple<Args...> &args, ClauseType c)
 	{
 	}
 
-	template<class Solver, unsigned int I = 0, typename... Args>
-	typename std::enable_if<I < sizeof...(Args), void>::type detach(Solver &s, std::tuple<Args...> &args, clause c)
+	template<class Solver, class ClauseType, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I < sizeof...(Args), void>::type detach(Solver &s, std::tuple<Args...> &args, ClauseType c)
 	{
 		std::get<I>(args).detach(s, c);
-		detach<Solver, I + 1>(s, args, c);
+		detach<Solver, ClauseType, I + 1>(s, args, c);
 	}
 
-	template<class Solver>
-	void detach(Solver &s, clause c)
+	template<class Solver, class ClauseType>
+	void detach(Solver &s, ClauseType c)
 	{
 		detach(s, plugins, c);
 	}
@@ -232,6 +232,42 @@ public:
 		restart(s, plugins);
 	}
 
+	template<class Solver, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I == sizeof...(Args), void>::type reduce(Solver &s, std::tuple<Args...> &args, unsigned int nr_core, unsigned int nr_tier2, unsigned int nr_local)
+	{
+	}
+
+	template<class Solver, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I < sizeof...(Args), void>::type reduce(Solver &s, std::tuple<Args...> &args, unsigned int nr_core, unsigned int nr_tier2, unsigned int nr_local)
+	{
+		std::get<I>(args).reduce(s, nr_core, nr_tier2, nr_local);
+		reduce<Solver, I + 1>(s, args, nr_core, nr_tier2, nr_local);
+	}
+
+	template<class Solver>
+	void reduce(Solver &s, unsigned int nr_core, unsigned int nr_tier2, unsigned int nr_local)
+	{
+		reduce(s, plugins, nr_core, nr_tier2, nr_local);
+	}
+
+	template<class Solver, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I == sizeof...(Args), void>::type reduce_time(Solver &s, std::tuple<Args...> &args, double seconds)
+	{
+	}
+
+	template<class Solver, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I < sizeof...(Args), void>::type reduce_time(Solver &s, std::tuple<Args...> &args, double seconds)
+	{
+		std::get<I>(args).reduce_time(s, seconds);
+		reduce_time<Solver, I + 1>(s, args, seconds);
+	}
+
+	template<class Solver>
+	void reduce_time(Solver &s, double seconds)
+	{
+		reduce_time(s, plugins, seconds);
+	}
+
 	template<class Solver, unsigned int I = 0, typename... Args>
 	typename std::enable_if<I == sizeof...(Args), void>::type sat(Solver &s, std::tuple<Args...> &args)
 	{
@@ -24,6 +24,8 @@
 #include <satxx11/clause.hh>
 #include <satxx11/literal.hh>
 #include <satxx11/plugin_base.hh>
+#include <satxx11/ternary_clause.hh>
+#include <satxx11/timer.hh>
 
 namespace satxx11 {
 
@@ -34,6 +36,10 @@ public:
 	unsigned int nr_restarts;
 	unsigned int nr_conflicts;
 	unsigned int nr_decisions;
+	unsigned long nr_propagations;
+
+	/* Since the last status line */
+	timer interval;
 
 	unsigned int nr_learnt_clauses_attached;
 	unsigned int nr_learnt_clauses_detached;
@@ -51,6 +57,15 @@ public:
 	unsigned int nr_clause_3;
 	unsigned int nr_clause_greater;
 
+	/* As of the last clause database reduction (if the reduction
+	 * heuristic tells us) */
+	unsigned int nr_core;
+	unsigned int nr_tier2;
+	unsigned int nr_local;
+
+	double last_reduce_time;
+	double total_reduce_time;
+
 	void header()
 	{
 		/* XXX: Dynamically adjust column widths. */
@@ -62,7 +77,10 @@ public:
 		printf("c  |    |      |      |        |             Learnt clauses (attached/detached)\n");
 		printf("c  |    |      |      |        |             |             Clause length (min/avg/max)\n");
 		printf("c  |    |      |      |        |             |             |           Learnt clauses (size 1/2/3/4+)\n");
-		printf("c  |    |      |      |        |             |             |           |\n");
+		printf("c  |    |      |      |        |             |             |           |           Reduction time in ms (last/total)\n");
+		printf("c  |    |      |      |        |             |             |           |           |           Learnt clauses kept (core/tier 2/local)\n");
+		printf("c  |    |      |      |        |             |             |           |           |           |           Propagations per second (thousands)\n");
+		printf("c  |    |      |      |        |             |             |           |           |           |           |\n");
 	}
 
 	plugin_stdio():
@@ -70,7 +88,12 @@ public:
 		nr_clause_1(0),
 		nr_clause_2(0),
 		nr_clause_3(0),
-		nr_clause_greater(0)
+		nr_clause_greater(0),
+		nr_core(0),
+		nr_tier2(0),
+		nr_local(0),
+		last_reduce_time(0),
+		total_reduce_time(0)
 	{
 		init();
 	}
@@ -79,6 +102,8 @@ public:
 	{
 		nr_conflicts = 0;
 		nr_decisions = 0;
+		nr_propagations = 0;
+		interval = timer();
 
 		nr_learnt_clauses_attached = 0;
 		nr_learnt_clauses_detached = 0;
@@ -137,6 +162,14 @@ public:
 		++nr_clause_2;
 	}
 
+	template<class Solver>
+	void attach(Solver &s, ternary_clause c)
+	{
+		attach(3);
+
+		++nr_clause_3;
+	}
+
 	template<class Solver>
 	void attach(Solver &s, clause c)
 	{
@@ -168,12 +201,24 @@ public:
 		++nr_learnt_clauses_detached;
 	}
 
+	template<class Solver>
+	void detach(Solver &s, ternary_clause c)
+	{
+		++nr_learnt_clauses_detached;
+	}
+
 	template<class Solver>
 	void decision(Solver &s, literal lit)
 	{
 		++nr_decisions;
 	}
 
+	template<class Solver>
+	void implication(Solver &s, literal lit, typename Solver::reason_type reason)
+	{
+		++nr_propagations;
+	}
+
 	template<class Solver>
 	void conflict(Solver &s)
 	{
@@ -192,6 +237,21 @@ public:
 			max_backtrack_level = decision;
 	}
 
+	template<class Solver>
+	void reduce(Solver &s, unsigned int core, unsigned int tier2, unsigned int local)
+	{
+		nr_core = core;
+		nr_tier2 = tier2;
+		nr_local = local;
+	}
+
+	template<class Solver>
+	void reduce_time(Solver &s, double seconds)
+	{
+		last_reduce_time = seconds;
+		total_reduce_time += seconds;
+	}
+
 	template<class Solver>
 	void restart(Solver &s)
 	{
@@ -203,13 +263,16 @@ public:
 			header();
 		}
 
-		printf("c %2u: %3u %6u %6u %3u/%06.2f/%-3u %6u/%-6u %2u/%06.2f/%-3u %2u/%2u/%2u/%2u\n",
+		printf("c %2u: %3u %6u %6u %3u/%06.2f/%-3u %6u/%-6u %2u/%06.2f/%-3u %2u/%2u/%2u/%2u %.2f/%-5.0f %u/%u/%u %.0f\n",
 			s.id,
 			nr_restarts, nr_conflicts, nr_decisions,
 			min_backtrack_level, avg_backtrack_level, max_backtrack_level,
 			nr_learnt_clauses_attached, nr_learnt_clauses_detached,
 			min_clause_length, avg_clause_length, max_clause_length,
-			nr_clause_1, nr_clause_2, nr_clause_3, nr_clause_greater);
+			nr_clause_1, nr_clause_2, nr_clause_3, nr_clause_greater,
+			1e3 * last_reduce_time, 1e3 * total_reduce_time,
+			nr_core, nr_tier2, nr_local,
+			1e-3 * nr_propagations / interval.elapsed());
 
 		init();
 	}
@@ -22,6 +22,7 @@
 #include <vector>
 
 #include <satxx11/binary_clause.hh>
+#include <satxx11/binary_graph.hh>
 #include <satxx11/erase.hh>
 #include <satxx11/literal.hh>
 
@@ -75,17 +76,23 @@ public:
 
 	typedef binary_clause_share share;
 
+	/* The original binary clauses; shared with the other threads. */
+	const binary_graph *graph;
+
+	/* Learnt binary clauses (our own and the ones we have received from
+	 * other threads). */
 	/* XXX: Use std::unique_ptr<> */
-	/* XXX: Share watchlists with other threads */
 	std::vector<literal> *watchlists;
 
-	propagate_binary_clause()
+	propagate_binary_clause():
+		graph(0)
 	{
 	}
 
 	template<class Solver>
 	void start(Solver &s)
 	{
+		graph = &s.store.binaries;
 		watchlists = new std::vector<literal>[2 * s.nr_variables];
 	}
 
@@ -103,6 +110,11 @@ public:
 	template<class Solver>
 	bool attach(Solver &s, binary_clause c)
 	{
+		/* The original clauses (i.e. everything that is attached
+		 * before the store is frozen) are already in the graph. */
+		if (!s.store.frozen)
+			return true;
+
 		watchlists[~c.a].push_back(c.b);
 		watchlists[~c.b].push_back(c.a);
 		return true;
@@ -118,7 +130,8 @@ public:
 
 		binary_clause c(v[0], v[1]);
 
-		/* Attach clause in all threads */
+		/* The clause is already in the shared implication graph, but
+		 * the other plugins of each thread need to know about it. */
 		bool all_ok = true;
 		for (unsigned int i = 0; i < s.nr_threads; ++i)
 			all_ok = all_ok && s.solvers[i]->attach(c);
@@ -128,7 +141,7 @@ public:
 	}
 
 	template<class Solver>
-	bool attach_learnt(Solver &s, const std::vector<literal> &v, bool &ok)
+	bool attach_learnt(Solver &s, const std::vector<literal> &v, unsigned int lbd, bool &ok)
 	{
 		if (v.size() != 2)
 			return false;
@@ -147,13 +160,21 @@ public:
 	{
 	}
 
+	/* NOTE: Original binary clauses can't be detached. */
 	template<class Solver>
 	void detach(Solver &s, binary_clause c)
 	{
+		assert_hotpath(s.store.frozen);
+
 		erase(watchlists[~c.a], c.b);
 		erase(watchlists[~c.b], c.a);
 	}
 
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+	}
+
 	/* Return false if and only if there was a conflict. */
 	template<class Solver>
 	bool propagate(Solver &s, literal lit)
@@ -161,10 +182,15 @@ public:
 		assert_hotpath(s.defined(lit));
 		assert_hotpath(s.value(lit));
 
-		/* Go through the watchlist; for each clause in the
-		 * watchlist, we need to assign the other literal to true. */
+		/* Go through the implication graph and the watchlist; for
+		 * each clause, we need to assign the other literal to true. */
+		for (literal other_lit: (*graph)[lit]) {
+			if (!s.implication(other_lit, binary_clause(other_lit, ~lit)))
+				return false;
+		}
+
 		for (literal other_lit: watchlists[lit]) {
-			if (!s.implication(other_lit, binary_clause(~lit, other_lit)))
+			if (!s.implication(other_lit, binary_clause(other_lit, ~lit)))
 				return false;
 		}
 
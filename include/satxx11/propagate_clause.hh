@@ -21,6 +21,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <utility>
 #include <vector>
 
 #include <satxx11/assert.hh>
@@ -51,8 +52,16 @@ public:
 
 	class clause_share {
 	public:
-		std::vector<clause> clauses;
-		std::vector<unsigned int> detached_clauses;
+		/* We send copies of the clauses rather than the clauses
+		 * themselves; the receiving thread allocates its own copy.
+		 * This way, a learnt clause is only ever used by the thread
+		 * that owns it, which is what allows the owner to move it
+		 * around (see clause_allocator). The literals of all the
+		 * clauses are stored one after another. */
+		std::vector<literal> literals;
+		std::vector<unsigned int> sizes;
+		std::vector<bool> learnt;
+		std::vector<unsigned char> lbds;
 
 		clause_share()
 		{
@@ -66,7 +75,12 @@ public:
 		template<class Solver>
 		void share(Solver &s, clause c)
 		{
-			clauses.push_back(c);
+			for (unsigned int i = 0, n = c.size(); i < n; ++i)
+				literals.push_back(c[i]);
+
+			sizes.push_back(c.size());
+			learnt.push_back(c.is_learnt());
+			lbds.push_back(c.lbd());
 		}
 
 		template<class Solver, class ClauseType>
@@ -74,22 +88,19 @@ public:
 		{
 		}
 
-		template<class Solver>
-		void detach(Solver &s, clause c)
-		{
-				detached_clauses.push_back(c.index());
-		}
-
 		template<class Solver>
 		bool restart(Solver &s)
 		{
-			/* XXX: Do this in a separate receive() function that is
-			 * called immediately when the message is received. There
-			 * is no reason to delay freeing the clause. */
-			for (unsigned int index: detached_clauses)
-				s.allocate.free(index);
+			std::vector<literal> v;
+			for (unsigned int i = 0, j = 0; i < sizes.size(); j += sizes[i++]) {
+				/* Learnt clauses are only a hint, so we can
+				 * do without them if we're short on memory. */
+				if (learnt[i] && s.allocate.low_on_memory())
+					continue;
+
+				v.assign(&literals[j], &literals[j] + sizes[i]);
 
-			for (clause c: clauses) {
+				clause c = s.allocate.allocate(learnt[i], v, lbds[i]);
 				if (!s.attach(c))
 					return false;
 
@@ -106,8 +117,20 @@ public:
 	/* XXX: Maybe put this in its own class using uint8 or something. */
 	watchlist *watchlists;
 
-	/* Use as follows: watches[thread_id][clause_id] */
-	std::vector<watch_indices> *watches;
+	/* Our own clauses are always watched by the literals in positions
+	 * 0 and 1; we simply move the literals around inside the clause.
+	 * We can't do that with the clauses in the clause_store, as they are
+	 * shared (and read-only), so for those we keep the positions of the
+	 * watched literals here (per thread), indexed by clause index. The
+	 * position where the last search for a new watch ended goes along
+	 * with them, like the search position in the header of our own
+	 * clauses. */
+	struct store_watch {
+		watch_indices indices;
+		uint16_t search;
+	};
+
+	std::vector<store_watch> store_watches;
 
 	propagate_clause()
 	{
@@ -117,13 +140,11 @@ public:
 	void start(Solver &s)
 	{
 		watchlists = new watchlist[2 * s.nr_variables];
-		watches = new std::vector<watch_indices>[s.nr_threads];
 	}
 
 	~propagate_clause()
 	{
 		delete[] watchlists;
-		delete[] watches;
 	}
 
 	template<class Solver, typename ClauseType>
@@ -140,14 +161,26 @@ public:
 		assert_hotpath(c.size() >= 2);
 		assert_hotpath(i != j);
 
-		watch_indices w(i, j);
-		watchlists[~c[w[0]]].insert(c);
-		watchlists[~c[w[1]]].insert(c);
+		if (s.store.contains(c)) {
+			watch_indices w(i, j);
+			watchlists[~c[w[0]]].insert(c, c[w[1]]);
+			watchlists[~c[w[1]]].insert(c, c[w[0]]);
+
+			if (store_watches.size() <= c.index())
+				store_watches.resize(s.store.nr_clauses);
+			store_watches[c.index()].indices = w;
+			store_watches[c.index()].search = 0;
+			return;
+		}
+
+		/* Move the watched literals to the front. */
+		std::swap(c[0], c[i]);
+		if (j == 0)
+			j = i;
+		std::swap(c[1], c[j]);
 
-		/* XXX: A bit ugly. Please fix. */
-		if (watches[c.thread()].size() <= c.index())
-			watches[c.thread()].resize(c.index() + 1);
-		watches[c.thread()][c.index()] = w;
+		watchlists[~c[0]].insert(c, c[1]);
+		watchlists[~c[1]].insert(c, c[0]);
 	}
 
 #if 0
@@ -263,8 +296,9 @@ public:
 			 * must be implied. */
 			/* XXX: implication() assumes the literal may be defined or undefined. From
 			 * this particular callsite it is always undefined, so we could optimize it. */
+			literal implied = c[found_undefined];
 			attach(s, c, found_undefined, found_false);
-			return s.implication(c[found_undefined], c);
+			return s.implication(implied, c);
 		}
 
 		/* No true literal and no undefined literal. This is a conflict
@@ -280,7 +314,7 @@ public:
 		if (v.size() < 2)
 			return false;
 
-		clause c = s.allocate.allocate(s.nr_threads, s.id, false, v);
+		clause c = s.store.add(v);
 
 		/* Attach clause in all threads */
 		bool all_ok = true;
@@ -293,15 +327,15 @@ public:
 	}
 
 	template<class Solver>
-	bool attach_learnt(Solver &s, const std::vector<literal> &v, bool &ok)
+	bool attach_learnt(Solver &s, const std::vector<literal> &v, unsigned int lbd, bool &ok)
 	{
 		if (v.size() < 2)
 			return false;
 
-		clause c = s.allocate.allocate(s.nr_threads, s.id, true, v);
+		clause c = s.allocate.allocate(true, v, lbd);
 
-		/* Attach clause in our own thread, but share it with the other
-		 * threads */
+		/* Attach clause in our own thread, but share (a copy of) it
+		 * with the other threads */
 		ok = s.attach(c);
 		s.share(c);
 		return true;
@@ -317,69 +351,133 @@ public:
 	{
 		debug_enter("clause = $", c);
 
-		unsigned int thread = c.thread();
-		unsigned int index = c.index();
+		/* The clauses in the store stay around forever; any other
+		 * clause is our own. */
+		if (s.store.contains(c)) {
+			watch_indices w = store_watches[c.index()].indices;
+			watchlists[~c[w[0]]].remove(c);
+			watchlists[~c[w[1]]].remove(c);
+		} else {
+			watchlists[~c[0]].remove(c);
+			watchlists[~c[1]].remove(c);
+			s.allocate.free(c.index());
+		}
+	}
+
+	/* Called when the clause allocator moves our clauses around. */
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+		for (unsigned int i = 0, n = 2 * s.nr_variables; i < n; ++i) {
+			for (watchlist::entry &e: watchlists[i].watches)
+				e.c = f(e.c);
+		}
+	}
 
-		watch_indices w = watches[thread][index];
-		watchlists[~c[w[0]]].remove(c);
-		watchlists[~c[w[1]]].remove(c);
+	/* Find a new watch for one of our own clauses; lit is the literal
+	 * that was just falsified. Return false if and only if there was a
+	 * conflict. */
+	template<class Solver>
+	bool find_new_watch(Solver &s, clause c, literal lit, bool &replace, literal &blocker)
+	{
+		debug_enter("clause = $", c);
 
-		/* After this, we are not allowed to keep any references to the
-		 * clause. So signal to the owning thread that we no longer hold
-		 * a reference to it. */
-		if (thread == s.id) {
-			/* We _are_ the owning thread. */
-			s.allocate.free(index);
-		} else {
-			s.output[thread]->empty = false;
-			s.output[thread]->share.detach(s, c);
+		clause::impl *data = c.get();
+		literal *literals = data->literals;
+
+		/* Make sure the falsified literal is in position 1. */
+		if (literals[0] == lit) {
+			literals[0] = literals[1];
+			literals[1] = lit;
 		}
+
+		assert_hotpath(literals[1] == lit);
+
+		literal other = literals[0];
+		if (other != blocker && s.defined(other) && s.value(other)) {
+			blocker = other;
+			return debug_return(true, "$ /* clause is satisfied */");
+		}
+
+		/* Look for a literal that is not false, starting where the
+		 * previous search ended. This avoids looking at the same false
+		 * literals over and over again in long clauses. */
+		unsigned int n = data->size;
+		unsigned int i = data->search;
+		if (i < 2 || i >= n)
+			i = 2;
+
+		for (unsigned int k = 2; k < n; ++k) {
+			literal l = literals[i];
+			if (!s.defined(l) || s.value(l)) {
+				data->search = i;
+				literals[1] = l;
+				literals[i] = lit;
+				replace = true;
+				watchlists[~l].insert(c, other);
+				return debug_return(true, "$ /* found new watch */");
+			}
+
+			if (++i == n)
+				i = 2;
+		}
+
+		/* All the other literals are false, so the other watch must
+		 * be satisfied (this is the implication). */
+		return debug_return(s.implication(other, c), "$");
 	}
 
-	/* Return false if and only if there was a conflict. */
+	/* Find a new watch for a clause in the clause_store; the watch in
+	 * position "watch" was just falsified. Return false if and only if
+	 * there was a conflict. */
 	template<class Solver>
-	bool find_new_watch(Solver &s, clause c, const watch_indices &wi, unsigned int watch, bool &replace)
+	bool find_new_store_watch(Solver &s, clause c, unsigned int watch, bool &replace, literal &blocker)
 	{
 		debug_enter("clause = $", c);
 
-		/* At this point we know that the watchlists may not be
-		 * entirely in sync with the current assignments, because
-		 * variables are assigned before the propagations are
-		 * actually carried out (and watchlists updated). */
+		store_watch &sw = store_watches[c.index()];
+		watch_indices &wi = sw.indices;
+
+		literal other = c[wi[!watch]];
+		if (other != blocker && s.defined(other) && s.value(other)) {
+			blocker = other;
+			return debug_return(true, "$ /* clause is satisfied */");
+		}
 
-		/* Find a new watch */
+		/* Look for a literal that is not false (and not watched),
+		 * starting where the previous search ended. */
 		unsigned int n = c.size();
-		for (unsigned int i = 0; i < n; ++i) {
-			literal l = c[i];
+		unsigned int i = sw.search;
+		if (i >= n)
+			i = 0;
+
+		for (unsigned int k = 0; k < n; ++k) {
+			if (i != wi[0] && i != wi[1]) {
+				literal l = c[i];
+				if (!s.defined(l)) {
+					sw.search = i;
+					wi[watch] = i;
+					replace = true;
+					watchlists[~l].insert(c, other);
+					return debug_return(true, "$ /* found new watch */");
+				}
 
-			if (s.defined(l)) {
+				/* The clause is satisfied; we keep the watch
+				 * and let the literal block it instead. */
 				if (s.value(l)) {
-					/* Literal was already satisfied;
-					 * clause is satisfied; we don't
-					 * need to do _anything_ else here */
+					sw.search = i;
+					blocker = l;
 					return debug_return(true, "$ /* clause is satisfied */");
 				}
-
-				/* Literal was falsified; we cannot
-				 * use it as a watch */
-				continue;
 			}
 
-			/* Don't select the other (existing) watch */
-			if (i == wi[!watch])
-				continue;
-
-			/* Replace the old watch with the new one */
-			replace = true;
-			watches[c.thread()][c.index()][watch] = i;
-			watchlists[~l].insert(c);
-			return debug_return(true, "$ /* found new watch */");
+			if (++i == n)
+				i = 0;
 		}
 
-		/* There was no other watch to replace the one we just
-		 * falsified; therefore, the other watched literal must
+		/* All the other literals are false, so the other watch must
 		 * be satisfied (this is the implication). */
-		return debug_return(s.implication(c[wi[!watch]], c), "$");
+		return debug_return(s.implication(other, c), "$");
 	}
 
 	/* Return false if and only if there was a conflict. */
@@ -401,29 +499,47 @@ public:
 		debug("watchlist size = $", n);
 
 		if (propagate_prefetch_first_clause < n)
-			__builtin_prefetch(w[propagate_prefetch_first_clause].data, 0);
+			__builtin_prefetch(w[propagate_prefetch_first_clause].c.get(), 0);
 
 		for (unsigned int i = 0; i < n;) {
 			if (i + propagate_prefetch_clause < n)
-				__builtin_prefetch(w[i + propagate_prefetch_clause].data, 0);
+				__builtin_prefetch(w[i + propagate_prefetch_clause].c.get(), 0);
 
-			if (i + propagate_prefetch_watchlist < n)
-				__builtin_prefetch(&watches[w[i + propagate_prefetch_watchlist].thread()][w[i + propagate_prefetch_watchlist].index()], 0);
+			if (i + propagate_prefetch_watchlist < n) {
+				clause c = w[i + propagate_prefetch_watchlist].c;
+				if (s.store.contains(c))
+					__builtin_prefetch(&store_watches[c.index()], 0);
+			}
 
 			/* Don't use "n" here... That's the whole point; we want to
 			 * make sure that n correctly reflects the true size of the
 			 * watchlist. */
 			assert_hotpath(i < w.size());
 
-			clause c = w[i];
-			watch_indices wi = watches[c.thread()][c.index()];
+			watchlist::entry &e = w[i];
 
-			/* This literal is exactly one of the watched literals */
-			assert_hotpath((c[wi[0]] == ~lit) ^ (c[wi[1]] == ~lit));
+			/* If the blocking literal is true, the clause is already
+			 * satisfied and we don't need to look at it at all. */
+			if (s.defined(e.blocker) && s.value(e.blocker)) {
+				++i;
+				continue;
+			}
 
+			clause c = e.c;
 			bool replace = false;
-			if (!find_new_watch(s, c, wi, c[wi[1]] == ~lit, replace))
-				return debug_return(false, "$");
+
+			if (s.store.contains(c)) {
+				watch_indices wi = store_watches[c.index()].indices;
+
+				/* This literal is exactly one of the watched literals */
+				assert_hotpath((c[wi[0]] == ~lit) ^ (c[wi[1]] == ~lit));
+
+				if (!find_new_store_watch(s, c, c[wi[1]] == ~lit, replace, e.blocker))
+					return debug_return(false, "$");
+			} else {
+				if (!find_new_watch(s, c, ~lit, replace, e.blocker))
+					return debug_return(false, "$");
+			}
 
 			if (replace) {
 				w.watches[i] = w.watches[--n];
@@ -151,24 +151,24 @@ public:
 	}
 
 	template<class Solver, unsigned int I = 0, typename... Args>
-	typename std::enable_if<I == sizeof...(Args), bool>::type attach_learnt(Solver &s, const std::vector<literal> &v, bool &ok, std::tuple<Args...> &args)
+	typename std::enable_if<I == sizeof...(Args), bool>::type attach_learnt(Solver &s, const std::vector<literal> &v, unsigned int lbd, bool &ok, std::tuple<Args...> &args)
 	{
 		return false;
 	}
 
 	template<class Solver, unsigned int I = 0, typename... Args>
-	typename std::enable_if<I < sizeof...(Args), bool>::type attach_learnt(Solver &s, const std::vector<literal> &v, bool &ok, std::tuple<Args...> &args)
+	typename std::enable_if<I < sizeof...(Args), bool>::type attach_learnt(Solver &s, const std::vector<literal> &v, unsigned int lbd, bool &ok, std::tuple<Args...> &args)
 	{
-		if (std::get<I>(args).attach_learnt(s, v, ok))
+		if (std::get<I>(args).attach_learnt(s, v, lbd, ok))
 			return true;
 
-		return attach_learnt<Solver, I + 1>(s, v, ok, args);
+		return attach_learnt<Solver, I + 1>(s, v, lbd, ok, args);
 	}
 
 	template<class Solver>
-	bool attach_learnt(Solver &s, const std::vector<literal> &v, bool &ok)
+	bool attach_learnt(Solver &s, const std::vector<literal> &v, unsigned int lbd, bool &ok)
 	{
-		return attach_learnt(s, v, ok, propagations);
+		return attach_learnt(s, v, lbd, ok, propagations);
 	}
 
 	template<class Solver, class ClauseType, unsigned int I = 0, typename... Args>
@@ -189,6 +189,24 @@ public:
 		detach(s, clause, propagations);
 	}
 
+	template<class Solver, typename Function, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I == sizeof...(Args), void>::type relocate(Solver &s, Function f, std::tuple<Args...> &args)
+	{
+	}
+
+	template<class Solver, typename Function, unsigned int I = 0, typename... Args>
+	typename std::enable_if<I < sizeof...(Args), void>::type relocate(Solver &s, Function f, std::tuple<Args...> &args)
+	{
+		std::get<I>(args).relocate(s, f);
+		relocate<Solver, Function, I + 1>(s, f, args);
+	}
+
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+		relocate(s, f, propagations);
+	}
+
 	template<class Solver, unsigned int I = 0, typename... Args>
 	typename std::enable_if<I == sizeof...(Args), bool>::type propagate(Solver &s, literal lit, std::tuple<Args...> &args)
 	{
@@ -0,0 +1,259 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_PROPAGATE_TERNARY_CLAUSE_HH
+#define SATXX11_PROPAGATE_TERNARY_CLAUSE_HH
+
+#include <vector>
+
+#include <satxx11/erase.hh>
+#include <satxx11/literal.hh>
+#include <satxx11/ternary_clause.hh>
+#include <satxx11/ternary_graph.hh>
+
+namespace satxx11 {
+
+/* Clauses of exactly three literals. All three literals are watched and
+ * each watch holds the two other literals of the clause, so propagation
+ * never needs to look at the clause itself (there isn't one).
+ *
+ * The original clauses are watched through the shared ternary_graph; only
+ * learnt clauses (our own and the ones we have received from other
+ * threads) go in our own watchlists. */
+class propagate_ternary_clause {
+public:
+	class ternary_clause_share {
+	public:
+		std::vector<ternary_clause> clauses;
+
+		ternary_clause_share()
+		{
+		}
+
+		template<class Solver, class ClauseType>
+		void share(Solver &s, ClauseType c)
+		{
+		}
+
+		template<class Solver>
+		void share(Solver &s, ternary_clause c)
+		{
+			clauses.push_back(c);
+		}
+
+		template<class Solver, class ClauseType>
+		void detach(Solver &s, ClauseType c)
+		{
+		}
+
+		template<class Solver>
+		bool restart(Solver &s)
+		{
+			for (ternary_clause c: clauses) {
+				if (!s.attach(c))
+					return false;
+
+				if (!s.stack.propagate(s))
+					return false;
+			}
+
+			return true;
+		}
+	};
+
+	typedef ternary_clause_share share;
+
+	class watch {
+	public:
+		literal a;
+		literal b;
+
+		watch(literal a, literal b):
+			a(a),
+			b(b)
+		{
+		}
+
+		bool operator==(const watch &other) const
+		{
+			return a == other.a && b == other.b;
+		}
+	};
+
+	/* The original ternary clauses; shared with the other threads. */
+	const ternary_graph *graph;
+
+	/* XXX: Use std::unique_ptr<> */
+	std::vector<watch> *watchlists;
+
+	propagate_ternary_clause():
+		graph(0)
+	{
+	}
+
+	template<class Solver>
+	void start(Solver &s)
+	{
+		graph = &s.store.ternaries;
+		watchlists = new std::vector<watch>[2 * s.nr_variables];
+	}
+
+	~propagate_ternary_clause()
+	{
+		delete[] watchlists;
+	}
+
+	template<class Solver, typename ClauseType>
+	bool attach(Solver &s, ClauseType c)
+	{
+		return true;
+	}
+
+	template<class Solver>
+	bool is_false(Solver &s, literal lit)
+	{
+		return s.defined(lit) && !s.value(lit);
+	}
+
+	/* Attach a clause that may be in any state. Returns false if and
+	 * only if there was a conflict. */
+	template<class Solver>
+	bool attach(Solver &s, ternary_clause c)
+	{
+		/* The original clauses (i.e. everything that is attached
+		 * before the store is frozen) are already in the graph; any
+		 * implications were made when the literals were assigned. */
+		if (!s.store.frozen)
+			return true;
+
+		watchlists[~c.a].push_back(watch(c.b, c.c));
+		watchlists[~c.b].push_back(watch(c.a, c.c));
+		watchlists[~c.c].push_back(watch(c.a, c.b));
+
+		/* If two of the literals are already false, the third one is
+		 * implied (or we have a conflict). */
+		if (is_false(s, c.b) && is_false(s, c.c))
+			return s.implication(c.a, c);
+		if (is_false(s, c.a) && is_false(s, c.c))
+			return s.implication(c.b, ternary_clause(c.b, c.a, c.c));
+		if (is_false(s, c.a) && is_false(s, c.b))
+			return s.implication(c.c, ternary_clause(c.c, c.a, c.b));
+
+		return true;
+	}
+
+	/* NOTE: Only use this for clauses attached before starting the
+	 * solver threads! */
+	template<class Solver>
+	bool attach(Solver &s, const std::vector<literal> &v, bool &ok)
+	{
+		if (v.size() != 3)
+			return false;
+
+		ternary_clause c(v[0], v[1], v[2]);
+
+		/* The clause is already in the shared graph, but the other
+		 * plugins of each thread need to know about it. */
+		bool all_ok = true;
+		for (unsigned int i = 0; i < s.nr_threads; ++i) {
+			all_ok = all_ok && s.solvers[i]->attach(c) && s.solvers[i]->stack.propagate(*s.solvers[i]);
+		}
+
+		ok = all_ok;
+		return true;
+	}
+
+	template<class Solver>
+	bool attach_learnt(Solver &s, const std::vector<literal> &v, unsigned int lbd, bool &ok)
+	{
+		if (v.size() != 3)
+			return false;
+
+		ternary_clause c(v[0], v[1], v[2]);
+
+		/* Attach clause in our own thread, but share it with the other
+		 * threads */
+		ok = s.attach(c);
+		s.share(c);
+		return true;
+	}
+
+	template<class Solver, typename ClauseType>
+	void detach(Solver &s, ClauseType c)
+	{
+	}
+
+	/* NOTE: Original ternary clauses can't be detached. */
+	template<class Solver>
+	void detach(Solver &s, ternary_clause c)
+	{
+		assert_hotpath(s.store.frozen);
+
+		erase(watchlists[~c.a], watch(c.b, c.c));
+		erase(watchlists[~c.b], watch(c.a, c.c));
+		erase(watchlists[~c.c], watch(c.a, c.b));
+	}
+
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+	}
+
+	/* The clause is (~lit, a, b) and ~lit was just falsified. If one of
+	 * the other literals is false too, the remaining one is implied.
+	 * Return false if and only if there was a conflict. */
+	template<class Solver>
+	bool propagate(Solver &s, literal lit, literal a, literal b)
+	{
+		if (s.defined(a)) {
+			if (s.value(a))
+				return true;
+
+			return s.implication(b, ternary_clause(b, ~lit, a));
+		}
+
+		if (s.defined(b) && !s.value(b))
+			return s.implication(a, ternary_clause(a, ~lit, b));
+
+		return true;
+	}
+
+	/* Return false if and only if there was a conflict. */
+	template<class Solver>
+	bool propagate(Solver &s, literal lit)
+	{
+		assert_hotpath(s.defined(lit));
+		assert_hotpath(s.value(lit));
+
+		for (ternary_graph::edge e: (*graph)[lit]) {
+			if (!propagate(s, lit, e.a, e.b))
+				return false;
+		}
+
+		for (watch w: watchlists[lit]) {
+			if (!propagate(s, lit, w.a, w.b))
+				return false;
+		}
+
+		return true;
+	}
+};
+
+}
+
+#endif
@@ -109,7 +109,7 @@ public:
 	}
 
 	template<class Solver>
-	bool attach_learnt(Solver &s, const std::vector<literal> &v, bool &ok)
+	bool attach_learnt(Solver &s, const std::vector<literal> &v, unsigned int lbd, bool &ok)
 	{
 		if (v.size() != 1)
 			return false;
@@ -126,6 +126,11 @@ public:
 	{
 	}
 
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+	}
+
 	/* Return false if and only if there was a conflict. */
 	template<class Solver>
 	bool propagate(Solver &s, literal lit)
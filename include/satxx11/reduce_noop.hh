@@ -40,8 +40,29 @@ public:
 	{
 	}
 
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+	}
+
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
+	{
+	}
+
+	template<class Solver>
+	void use(Solver &s, clause c)
+	{
+	}
+
+	template<class Solver>
+	void conflict(Solver &s)
+	{
+	}
+
+	/* Make the next call to operator() reduce. */
 	template<class Solver>
-	void resolve(Solver &s, const std::vector<literal> &v)
+	void force(Solver &s)
 	{
 	}
 
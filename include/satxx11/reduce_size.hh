@@ -23,16 +23,23 @@
 #include <vector>
 
 #include <satxx11/clause.hh>
+#include <satxx11/ternary_clause.hh>
+#include <satxx11/timer.hh>
 
 namespace satxx11 {
 
 /* Detach clauses based on their size (similar to minisat 2.2.0 heuristic);
  * all clauses smaller than a certain size are kept and approximately half
- * of all other learnt clauses are kept. */
+ * of all other learnt clauses are kept.
+ *
+ * Learnt ternary clauses are shorter than any of the (long) clauses, so
+ * they are the first to be kept; if they make up more than half, the
+ * oldest ones are detached. */
 template<unsigned int size>
 class reduce_size {
 public:
 	std::vector<clause> clauses;
+	std::vector<ternary_clause> ternaries;
 
 	template<class Solver>
 	reduce_size(Solver &s)
@@ -58,13 +65,41 @@ public:
 		clauses.push_back(c);
 	}
 
+	template<class Solver>
+	void attach(Solver &s, ternary_clause c)
+	{
+		/* The original clauses are attached before the store is
+		 * frozen. */
+		if (!s.store.frozen || 3 <= size)
+			return;
+
+		ternaries.push_back(c);
+	}
+
 	template<class Solver, class ClauseType>
 	void detach(Solver &s, ClauseType c)
 	{
 	}
 
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+		for (clause &c: clauses)
+			c = f(c);
+	}
+
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
+	{
+	}
+
+	template<class Solver>
+	void use(Solver &s, clause c)
+	{
+	}
+
 	template<class Solver>
-	void resolve(Solver &s, const std::vector<literal> &v)
+	void conflict(Solver &s)
 	{
 	}
 
@@ -75,18 +110,42 @@ public:
 		}
 	};
 
+	/* Make the next call to operator() reduce (it always does). */
+	template<class Solver>
+	void force(Solver &s)
+	{
+	}
+
 	template<class Solver>
 	void operator()(Solver &s)
 	{
-		std::sort(clauses.begin(), clauses.end(), clause_compare());
+		timer t;
+
+		unsigned long nr_keep = (clauses.size() + ternaries.size()) / 2;
+		if (ternaries.size() > nr_keep) {
+			auto end = ternaries.end() - nr_keep;
+			for (auto it = ternaries.begin(); it != end; ++it)
+				s.detach(*it);
+
+			ternaries.erase(ternaries.begin(), end);
+			nr_keep = 0;
+		} else {
+			nr_keep -= ternaries.size();
+		}
 
-		auto begin = clauses.begin() + clauses.size() / 2;
+		/* We only need to know which half each clause belongs in,
+		 * which is a linear-time selection rather than a sort. */
+		auto begin = clauses.begin() + nr_keep;
 		auto end = clauses.end();
 
+		std::nth_element(clauses.begin(), begin, end, clause_compare());
+
 		for (auto it = begin; it != end; ++it)
 			s.detach(*it);
 
 		clauses.erase(begin, end);
+
+		s.plugin.reduce_time(s, t.elapsed());
 	}
 };
 
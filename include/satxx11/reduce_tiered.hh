@@ -0,0 +1,299 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_REDUCE_TIERED_HH
+#define SATXX11_REDUCE_TIERED_HH
+
+#include <algorithm>
+#include <vector>
+
+#include <satxx11/clause.hh>
+#include <satxx11/ternary_clause.hh>
+#include <satxx11/timer.hh>
+
+namespace satxx11 {
+
+/* Detach clauses based on their LBD and on how recently they were used
+ * (similar to the three-tier scheme of recent CDCL solvers):
+ *
+ *  - "core" clauses (LBD <= core_lbd) are kept forever;
+ *  - "tier 2" clauses (LBD <= tier2_lbd) are kept as long as they have
+ *    taken part in a conflict since the previous reduction; otherwise,
+ *    they are moved to the local tier;
+ *  - "local" clauses are kept if they were used since the previous
+ *    reduction; of the rest, the less active half is detached.
+ *
+ * Learnt ternary clauses have no index, so we can't tell whether they have
+ * been used; we keep the ones that were learnt since the previous
+ * reduction and the newer half of the older ones.
+ *
+ * A clause can move to a better tier whenever its LBD improves. We only
+ * reduce once a certain number of conflicts have passed (first, then
+ * increment more for each reduction after that); as the solver calls us
+ * on restarts, this happens at the first restart after that. */
+template<unsigned int core_lbd = 2,
+	unsigned int tier2_lbd = 6,
+	unsigned int first = 2000,
+	unsigned int increment = 300>
+class reduce_tiered {
+public:
+	enum {
+		CORE,
+		TIER2,
+		LOCAL,
+	};
+
+	/* All the learnt clauses that are not (known to be) in the core. */
+	std::vector<clause> clauses;
+
+	/* Learnt ternary clauses, oldest first */
+	std::vector<ternary_clause> ternaries;
+	unsigned long nr_old_ternaries;
+
+	/* Indexed by clause index */
+	std::vector<unsigned char> tiers;
+	std::vector<bool> used;
+	std::vector<float> activities;
+
+	float activity_inc;
+
+	unsigned long nr_conflicts;
+	unsigned long next_reduce;
+	unsigned int nr_reductions;
+
+	/* Tier sizes, for the statistics */
+	unsigned int nr_core;
+	unsigned int nr_tier2;
+	unsigned int nr_local;
+
+	template<class Solver>
+	reduce_tiered(Solver &s):
+		nr_old_ternaries(0),
+		activity_inc(1),
+		nr_conflicts(0),
+		next_reduce(first),
+		nr_reductions(0),
+		nr_core(0),
+		nr_tier2(0),
+		nr_local(0)
+	{
+	}
+
+	static unsigned int tier(unsigned int lbd)
+	{
+		if (lbd <= core_lbd)
+			return CORE;
+		if (lbd <= tier2_lbd)
+			return TIER2;
+		return LOCAL;
+	}
+
+	void count(unsigned int t, int delta)
+	{
+		if (t == CORE)
+			nr_core += delta;
+		else if (t == TIER2)
+			nr_tier2 += delta;
+		else
+			nr_local += delta;
+	}
+
+	template<class Solver, class ClauseType>
+	void attach(Solver &s, ClauseType c)
+	{
+	}
+
+	template<class Solver>
+	void attach(Solver &s, clause c)
+	{
+		/* Never try to detach non-learnt clauses */
+		if (!c.is_learnt())
+			return;
+
+		unsigned int index = c.index();
+		if (index >= tiers.size()) {
+			tiers.resize(index + 1);
+			used.resize(index + 1);
+			activities.resize(index + 1);
+		}
+
+		unsigned int t = tier(c.lbd());
+		tiers[index] = t;
+		used[index] = false;
+		activities[index] = 0;
+		count(t, 1);
+
+		if (t != CORE)
+			clauses.push_back(c);
+	}
+
+	template<class Solver>
+	void attach(Solver &s, ternary_clause c)
+	{
+		/* The original clauses are attached before the store is
+		 * frozen. */
+		if (!s.store.frozen)
+			return;
+
+		ternaries.push_back(c);
+	}
+
+	template<class Solver, class ClauseType>
+	void detach(Solver &s, ClauseType c)
+	{
+	}
+
+	template<class Solver>
+	void detach(Solver &s, clause c)
+	{
+		if (!c.is_learnt())
+			return;
+
+		count(tiers[c.index()], -1);
+	}
+
+	template<class Solver, typename Function>
+	void relocate(Solver &s, Function f)
+	{
+		for (clause &c: clauses)
+			c = f(c);
+	}
+
+	template<class Solver, typename Literals>
+	void resolve(Solver &s, const Literals &v)
+	{
+	}
+
+	/* Called for every learnt clause that takes part in conflict
+	 * analysis (after its LBD has been updated). */
+	template<class Solver>
+	void use(Solver &s, clause c)
+	{
+		unsigned int index = c.index();
+		used[index] = true;
+
+		unsigned int t = tier(c.lbd());
+		if (t < tiers[index]) {
+			count(tiers[index], -1);
+			count(t, 1);
+			tiers[index] = t;
+		}
+
+		if ((activities[index] += activity_inc) > 1e20) {
+			for (clause c: clauses)
+				activities[c.index()] *= 1e-20;
+
+			activity_inc *= 1e-20;
+		}
+	}
+
+	template<class Solver>
+	void conflict(Solver &s)
+	{
+		++nr_conflicts;
+		activity_inc *= 1 / 0.999;
+	}
+
+	struct clause_compare {
+		const std::vector<float> &activities;
+
+		clause_compare(const std::vector<float> &activities):
+			activities(activities)
+		{
+		}
+
+		bool operator()(clause a, clause b)
+		{
+			return activities[a.index()] > activities[b.index()];
+		}
+	};
+
+	/* Make the next call to operator() reduce, even if not enough
+	 * conflicts have passed yet. */
+	template<class Solver>
+	void force(Solver &s)
+	{
+		next_reduce = nr_conflicts;
+	}
+
+	template<class Solver>
+	void operator()(Solver &s)
+	{
+		if (nr_conflicts < next_reduce)
+			return;
+
+		timer t;
+
+		++nr_reductions;
+		next_reduce = nr_conflicts + first + increment * nr_reductions;
+
+		/* Go through the clauses; keep the ones that were used and
+		 * collect the unused local clauses at the end. */
+		std::vector<clause> candidates;
+
+		unsigned int j = 0;
+		for (clause c: clauses) {
+			unsigned int index = c.index();
+
+			/* Promoted to the core since the last reduction */
+			if (tiers[index] == CORE)
+				continue;
+
+			if (used[index]) {
+				used[index] = false;
+				clauses[j++] = c;
+				continue;
+			}
+
+			if (tiers[index] == TIER2) {
+				count(TIER2, -1);
+				count(LOCAL, 1);
+				tiers[index] = LOCAL;
+				clauses[j++] = c;
+				continue;
+			}
+
+			candidates.push_back(c);
+		}
+
+		clauses.resize(j);
+
+		auto begin = candidates.begin() + candidates.size() / 2;
+		auto end = candidates.end();
+
+		std::nth_element(candidates.begin(), begin, end, clause_compare(activities));
+
+		clauses.insert(clauses.end(), candidates.begin(), begin);
+		for (auto it = begin; it != end; ++it)
+			s.detach(*it);
+
+		auto ternaries_end = ternaries.begin() + nr_old_ternaries / 2;
+		for (auto it = ternaries.begin(); it != ternaries_end; ++it)
+			s.detach(*it);
+
+		ternaries.erase(ternaries.begin(), ternaries_end);
+		nr_old_ternaries = ternaries.size();
+
+		s.plugin.reduce(s, nr_core, nr_tier2, nr_local);
+		s.plugin.reduce_time(s, t.elapsed());
+	}
+};
+
+}
+
+#endif
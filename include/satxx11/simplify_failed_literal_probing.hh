@@ -38,17 +38,22 @@ public:
 	{
 	}
 
+	/* Returns false if and only if we found a conflict at decision
+	 * level 0 (i.e. the instance is unsatisfiable). */
 	template<class Solver>
-	unsigned int probe(Solver &s, unsigned int var)
+	bool probe(Solver &s, unsigned int var, unsigned int &nr_literals)
 	{
-		unsigned int nr_literals = 0;
-
 		for (bool value: {false, true}) {
 			if (s.defined(var))
 				continue;
 
 			s.stack.decision(s, literal(var, value));
 			while (!s.stack.propagate(s)) {
+				/* The literal we learnt from the previous
+				 * conflict led to another conflict. */
+				if (s.stack.decision_index == 0)
+					return false;
+
 				s.analyze(s);
 				++nr_literals;
 			}
@@ -57,24 +62,26 @@ public:
 				s.stack.backtrack(s, 0);
 		}
 
-		return nr_literals;
+		return true;
 	}
 
+	/* Returns false if and only if the instance is unsatisfiable. */
 	template<class Solver>
-	void operator()(Solver &s)
+	bool operator()(Solver &s)
 	{
 		assert(s.stack.decision_index == 0);
 
 		unsigned int nr_literals = 0;
+		bool ok = true;
 
 		if (nr_rounds % 100 == 0) {
 			/* Try a random share of the variables. */
-			for (unsigned int i = 0, n = s.nr_variables / s.nr_threads; i < n; ++i)
-				nr_literals += probe(s, s.random() % s.nr_variables);
+			for (unsigned int i = 0, n = s.nr_variables / s.nr_threads; ok && i < n; ++i)
+				ok = probe(s, s.random() % s.nr_variables, nr_literals);
 		} else {
 			/* Try a random one percent of the variables. */
-			for (unsigned int i = 0, n = s.nr_variables / 100; i < n; ++i)
-				nr_literals += probe(s, s.random() % s.nr_variables);
+			for (unsigned int i = 0, n = s.nr_variables / 100; ok && i < n; ++i)
+				ok = probe(s, s.random() % s.nr_variables, nr_literals);
 		}
 
 		/* XXX: Don't abuse printf like this. The other plugins might want to
@@ -83,6 +90,7 @@ public:
 			printf("c Failed literal probing learned %u literals\n", nr_literals);
 
 		++nr_rounds;
+		return ok;
 	}
 };
 
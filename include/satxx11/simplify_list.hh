@@ -35,21 +35,26 @@ public:
 	}
 
 	template<class Solver, unsigned int I = 0, typename... Args>
-	typename std::enable_if<I == sizeof...(Args), void>::type call(Solver &s, std::tuple<Args...> &t)
+	typename std::enable_if<I == sizeof...(Args), bool>::type call(Solver &s, std::tuple<Args...> &t)
 	{
+		return true;
 	}
 
 	template<class Solver, unsigned int I = 0, typename... Args>
-	typename std::enable_if<I < sizeof...(Args), void>::type call(Solver &s, std::tuple<Args...> &t)
+	typename std::enable_if<I < sizeof...(Args), bool>::type call(Solver &s, std::tuple<Args...> &t)
 	{
-		std::get<I>(t)(s);
-		call<Solver, I + 1>(s, t);
+		if (!std::get<I>(t)(s))
+			return false;
+
+		return call<Solver, I + 1>(s, t);
 	}
 
+	/* Returns false if and only if the instance was found to be
+	 * unsatisfiable. */
 	template<class Solver>
-	void operator()(Solver &s)
+	bool operator()(Solver &s)
 	{
-		call(s, simplifies);
+		return call(s, simplifies);
 	}
 };
 
@@ -25,9 +25,14 @@
 #include <satxx11/analyze_1uip.hh>
 #include <satxx11/clause.hh>
 #include <satxx11/clause_allocator.hh>
+#include <satxx11/clause_store.hh>
+#include <satxx11/cnf.hh>
 #include <satxx11/debug.hh>
 #include <satxx11/decide_cached_polarity.hh>
+#include <satxx11/decide_lrb.hh>
+#include <satxx11/decide_mode_switch.hh>
 #include <satxx11/decide_random.hh>
+#include <satxx11/decide_vmtf.hh>
 #include <satxx11/decide_vsids.hh>
 #include <satxx11/literal.hh>
 #include <satxx11/minimise_minisat.hh>
@@ -38,10 +43,12 @@
 #include <satxx11/propagate_binary_clause.hh>
 #include <satxx11/propagate_clause.hh>
 #include <satxx11/propagate_list.hh>
+#include <satxx11/propagate_ternary_clause.hh>
 #include <satxx11/propagate_unary_clause.hh>
 #include <satxx11/receive_all.hh>
 #include <satxx11/reduce_noop.hh>
 #include <satxx11/reduce_size.hh>
+#include <satxx11/reduce_tiered.hh>
 #include <satxx11/restart_fixed.hh>
 #include <satxx11/restart_geometric.hh>
 #include <satxx11/restart_luby.hh>
@@ -50,7 +57,9 @@
 #include <satxx11/simplify_list.hh>
 #include <satxx11/simplify_failed_literal_probing.hh>
 #include <satxx11/stack_default.hh>
+#include <satxx11/valuation_byte.hh>
 #include <satxx11/valuation_compact.hh>
+#include <satxx11/variable_remap.hh>
 
 /* Workaround for missing implementation in libstdc++ for gcc 4.6. */
 namespace std {
@@ -78,19 +87,15 @@ void atomic_thread_fence(memory_order __m)
 
 namespace satxx11 {
 
-typedef unsigned int variable;
-typedef std::map<variable, variable> variable_map;
-typedef std::vector<literal> literal_vector;
-typedef std::vector<literal_vector> literal_vector_vector;
-
 template<class ReasonType,
 	class Random = std::ranlux24_base,
-	class Valuation = valuation_compact,
+	class Valuation = valuation_byte,
 	class Stack = stack_default,
 	class Decide = decide_cached_polarity<decide_vsids<95>>,
 	class Propagate = propagate_list<
 		propagate_unary_clause,
 		propagate_binary_clause,
+		propagate_ternary_clause,
 		propagate_clause<>>,
 	class Analyze = analyze_1uip<minimise_minisat>,
 	class Send = send_size<4>,
@@ -109,13 +114,24 @@ public:
 	bool keep_going;
 	std::atomic<bool> &should_exit;
 	unsigned int nr_variables;
-	const variable_map &variables;
-	const variable_map &reverse_variables;
-	const literal_vector_vector &original_clauses;
+	const variable_remap &variables;
+	const cnf &original_clauses;
+
+	/* Shared by all threads */
+	clause_store &store;
+
+	/* Per-variable data that conflict analysis always needs together:
+	 * the reason why a variable was set (if it was implied) and the
+	 * decision level at which it was set. Keeping them in the same
+	 * record means that analysis takes one cache miss per variable
+	 * instead of one per array. */
+	struct variable_state {
+		reason_type reason;
+		unsigned int level;
+	};
 
-	/* Indexed by variable. Gives the reason why a variable was set
-	 * if the variable was implied. */
-	reason_type *reasons;
+	/* XXX: Use std::unique_ptr<> */
+	variable_state *state;
 
 	literal conflict_literal;
 	reason_type conflict_reason;
@@ -161,9 +177,9 @@ public:
 		bool keep_going,
 		std::atomic<bool> &should_exit,
 		unsigned long seed,
-		const variable_map &variables,
-		const variable_map &reverse_variables,
-		const literal_vector_vector &original_clauses):
+		const variable_remap &variables,
+		const cnf &original_clauses,
+		clause_store &store):
 
 		nr_threads(nr_threads),
 		solvers(solvers),
@@ -172,10 +188,12 @@ public:
 		should_exit(should_exit),
 		nr_variables(variables.size()),
 		variables(variables),
-		reverse_variables(reverse_variables),
 		original_clauses(original_clauses),
+		store(store),
 
-		reasons(new reason_type[nr_variables]),
+		state(new variable_state[nr_variables]),
+
+		allocate(nr_threads, id),
 
 		/* XXX: Not RAII. */
 		output(new message *[nr_threads]),
@@ -195,8 +213,10 @@ public:
 			output[i] = new message();
 
 		/* XXX: Necessary? */
-		for (unsigned int i = 0; i < nr_variables; ++i)
-			reasons[i] = reason_type();
+		for (unsigned int i = 0; i < nr_variables; ++i) {
+			state[i].reason = reason_type();
+			state[i].level = 0;
+		}
 
 		propagate.start(*this);
 	}
@@ -207,6 +227,7 @@ public:
 			delete output[i];
 
 		delete[] output;
+		delete[] state;
 	}
 
 	__attribute__ ((warn_unused_result))
@@ -244,16 +265,18 @@ public:
 
 	void assign(literal l, bool value)
 	{
-		valuation.assign(*this, l.variable(), l.value() == value);
+		assign(l.variable(), l.value() == value);
 	}
 
 	void unassign(unsigned int variable)
 	{
 		debug_enter("variable = $", variable);
 
-		valuation.unassign(*this, variable);
+		/* The plugins may still look at the old value (e.g. for
+		 * phase saving). */
 		decide.unassign(*this, variable);
 		plugin.unassign(*this, variable);
+		valuation.unassign(*this, variable);
 	}
 
 	template<typename ClauseType>
@@ -297,10 +320,10 @@ public:
 	 * This is most useful for clause learning, which we want to be
 	 * independent of the actual clause types supported by the solver. */
 	__attribute__ ((warn_unused_result))
-	bool attach_learnt(const std::vector<literal> &c)
+	bool attach_learnt(const std::vector<literal> &c, unsigned int lbd)
 	{
 		bool ok;
-		bool found = propagate.attach_learnt(*this, c, ok);
+		bool found = propagate.attach_learnt(*this, c, lbd, ok);
 		assert(found);
 		return ok;
 	}
@@ -336,11 +359,13 @@ public:
 
 	void decision(literal lit)
 	{
-		reasons[lit.variable()] = reason_type();
+		state[lit.variable()].reason = reason_type();
 		stack.decision(*this, lit);
 		plugin.decision(*this, lit);
 	}
 
+	/* NOTE: Reasons made from binary_clause or ternary_clause must have
+	 * the implied literal first; the reason type may not keep it. */
 	__attribute__ ((warn_unused_result))
 	bool implication(literal lit, reason_type reason = reason_type())
 	{
@@ -355,7 +380,7 @@ public:
 			return false;
 		}
 
-		reasons[lit.variable()] = reason;
+		state[lit.variable()].reason = reason;
 		plugin.implication(*this, lit, reason);
 		stack.implication(*this, lit);
 		return true;
@@ -368,15 +393,24 @@ public:
 	}
 
 	/* XXX: We would also like to know what we are resolving _with_... */
-	void resolve(const std::vector<literal> &v)
+	template<typename Literals>
+	void resolve(const Literals &v)
 	{
 		decide.resolve(*this, v);
 		reduce.resolve(*this, v);
 	}
 
+	/* Called for each learnt clause that takes part in conflict
+	 * analysis. */
+	void use(clause c)
+	{
+		reduce.use(*this, c);
+	}
+
 	void conflict()
 	{
 		decide.conflict(*this);
+		reduce.conflict(*this);
 		plugin.conflict(*this);
 	}
 
@@ -455,7 +489,8 @@ public:
 		 * the stdout plugin from seeing backtrack(0) in every restart,
 		 * and always printing 0 as the minimum backtrack level. */
 		plugin.restart(*this);
-		simplify(*this);
+		if (!simplify(*this))
+			return false;
 
 		for (message *m: pending_messages) {
 			if (!m->share.restart(*this))
@@ -483,14 +518,38 @@ public:
 		return true;
 	}
 
+	/* Move our clauses closer together once enough of them have been
+	 * freed. This must be done at decision level 0. */
+	void compact()
+	{
+		if (!allocate.should_compact()) {
+			allocate.update_pressure();
+			return;
+		}
+
+		allocate.prepare_compact();
+
+		auto relocate = [this](clause c) {
+			return allocate.relocate(c);
+		};
+
+		propagate.relocate(*this, relocate);
+		reduce.relocate(*this, relocate);
+
+		for (unsigned int i = 0; i < stack.trail_size; ++i)
+			state[stack.trail[i]].reason.relocate(relocate);
+
+		allocate.compact();
+	}
+
 	void sat()
 	{
 		plugin.sat(*this);
 
 		/* Verify that the solution is indeed a solution */
-		for (const literal_vector &c: original_clauses) {
+		for (unsigned long i = 0, n = original_clauses.size(); i < n; ++i) {
 			bool v = false;
-			for (literal lit: c) {
+			for (literal lit: original_clauses[i]) {
 				assert(defined(lit));
 				v = v || value(lit);
 			}
@@ -498,32 +557,17 @@ public:
 			assert(v);
 		}
 
-		std::ostringstream ss;
-
-		variable_map::const_iterator it = variables.begin();
-		variable_map::const_iterator end = variables.end();
-
-		if (it != end) {
-			assert(defined(it->second));
-
-			if (!value(it->second))
-				ss << "-";
-
-			ss << it->first;
-		}
-
-		while (++it != end) {
-			assert(defined(it->second));
-
-			ss << " ";
+		/* Print the model in increasing order of input variable. */
+		std::string line("v");
+		variables.for_each([&](variable input, variable var) {
+			assert(defined(var));
 
-			if (!value(it->second))
-				ss << "-";
+			char buffer[16];
+			sprintf(buffer, value(var) ? " %u" : " -%u", input);
+			line += buffer;
+		});
 
-			ss << it->first;
-		}
-
-		printf("v %s 0\n", ss.str().c_str());
+		printf("%s 0\n", line.c_str());
 		printf("s SATISFIABLE\n");
 	}
 
@@ -544,7 +588,8 @@ public:
 		/* Simplify the instance before doing anything else. */
 		/* XXX: Maybe this should really be a restart? We need to signal
 		 * the other plugins too in any case. */
-		simplify(*this);
+		if (!simplify(*this))
+			unsat();
 
 		unsigned int nr_conflicts = next_restart(*this);
 		assert(nr_conflicts > 0);
@@ -661,7 +706,7 @@ public:
 
 					share(conflict_clause[0]);
 				} else {
-					clause learnt_clause = allocate.allocate(nr_threads, id, false, conflict_clause);
+					clause learnt_clause = allocate.allocate(false, conflict_clause);
 					if (!attach(learnt_clause)) {
 						should_exit = true;
 						break;
@@ -687,8 +732,10 @@ public:
 					break;
 				}
 
-				if (--nr_conflicts == 0) {
-					/* Restart */
+				/* Restart; we also restart (and reduce right
+				 * away) if we're running out of clause memory. */
+				bool low_on_memory = allocate.low_on_memory();
+				if (--nr_conflicts == 0 || low_on_memory) {
 					nr_conflicts = next_restart(*this);
 					assert(nr_conflicts > 0);
 
@@ -697,7 +744,11 @@ public:
 						break;
 					}
 
+					if (low_on_memory)
+						reduce.force(*this);
+
 					reduce(*this);
+					compact();
 					break;
 				}
 
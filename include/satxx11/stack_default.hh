@@ -31,17 +31,13 @@ public:
 	unsigned int *decisions;
 	unsigned int decision_index;
 
-	/* Decision level at which the variable was set. */
-	unsigned int *levels;
-
 	template<class Solver>
 	stack_default(Solver &s):
 		trail(new unsigned int[s.nr_variables]),
 		trail_index(0),
 		trail_size(0),
 		decisions(new unsigned int[s.nr_variables]),
-		decision_index(0),
-		levels(new unsigned int[s.nr_variables])
+		decision_index(0)
 	{
 	}
 
@@ -49,7 +45,6 @@ public:
 	{
 		delete[] trail;
 		delete[] decisions;
-		delete[] levels;
 	}
 
 	template<class Solver>
@@ -72,7 +67,7 @@ public:
 		decisions[decision_index] = trail_size;
 		++trail_size;
 		++decision_index;
-		levels[variable] = decision_index;
+		s.state[variable].level = decision_index;
 	}
 
 	/* Called whenever a variable is forced to a particular value. The
@@ -89,7 +84,7 @@ public:
 		s.assign(lit, true);
 		trail[trail_size] = variable;
 		++trail_size;
-		levels[variable] = decision_index;
+		s.state[variable].level = decision_index;
 	}
 
 	/* Return false if and only if there was a conflict. */
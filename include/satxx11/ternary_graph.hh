@@ -0,0 +1,135 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_TERNARY_GRAPH_HH
+#define SATXX11_TERNARY_GRAPH_HH
+
+#include <cstdint>
+#include <vector>
+
+#include <satxx11/assert_hotpath.hh>
+#include <satxx11/cnf.hh>
+#include <satxx11/literal.hh>
+
+namespace satxx11 {
+
+/* The original ternary clauses, stored in compressed sparse row form like
+ * binary_graph: for each clause (x, y, z), the row of ~x holds the pair
+ * (y, z), and likewise for ~y and ~z. In other words, when literal l
+ * becomes true, the clauses that may become unit are (~l, a, b) for the
+ * pairs (a, b) in rows[offsets[l]] .. rows[offsets[l + 1] - 1].
+ *
+ * Like the binary graph, this is built once from the instance before the
+ * solver threads are created and is shared by all of them. */
+class ternary_graph {
+public:
+	class edge {
+	public:
+		literal a;
+		literal b;
+
+		edge()
+		{
+		}
+
+		edge(literal a, literal b):
+			a(a),
+			b(b)
+		{
+		}
+	};
+
+	class range {
+	public:
+		const edge *first;
+		const edge *last;
+
+		range(const edge *first, const edge *last):
+			first(first),
+			last(last)
+		{
+		}
+
+		const edge *begin() const
+		{
+			return first;
+		}
+
+		const edge *end() const
+		{
+			return last;
+		}
+	};
+
+	std::vector<uint64_t> offsets;
+	std::vector<edge> edges;
+
+	ternary_graph(unsigned int nr_variables, const cnf &clauses):
+		offsets(2 * nr_variables + 1, 0)
+	{
+		/* See binary_graph for how this works. */
+		for (unsigned long i = 0, n = clauses.size(); i < n; ++i) {
+			cnf::span c = clauses[i];
+			if (c.size() != 3)
+				continue;
+
+			++offsets[(~c[0]) + 1];
+			++offsets[(~c[1]) + 1];
+			++offsets[(~c[2]) + 1];
+		}
+
+		for (unsigned int i = 1; i < offsets.size(); ++i)
+			offsets[i] += offsets[i - 1];
+
+		edges.resize(offsets.back());
+
+		for (unsigned long i = 0, n = clauses.size(); i < n; ++i) {
+			cnf::span c = clauses[i];
+			if (c.size() != 3)
+				continue;
+
+			edges[offsets[~c[0]]++] = edge(c[1], c[2]);
+			edges[offsets[~c[1]]++] = edge(c[0], c[2]);
+			edges[offsets[~c[2]]++] = edge(c[0], c[1]);
+		}
+
+		for (unsigned int i = offsets.size() - 1; i > 0; --i)
+			offsets[i] = offsets[i - 1];
+		offsets[0] = 0;
+	}
+
+	ternary_graph(const ternary_graph &) = delete;
+	ternary_graph &operator=(const ternary_graph &) = delete;
+
+	unsigned long size() const
+	{
+		return edges.size() / 3;
+	}
+
+	range operator[](literal lit) const
+	{
+		assert_hotpath(lit + 1 < offsets.size());
+
+		const edge *data = edges.data();
+		return range(data + offsets[lit], data + offsets[lit + 1]);
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_TIMER_HH
+#define SATXX11_TIMER_HH
+
+extern "C" {
+#include <sys/time.h>
+}
+
+#include <satxx11/assert.hh>
+
+namespace satxx11 {
+
+/* Measures the wall time since it was created. */
+class timer {
+public:
+	struct timeval start;
+
+	timer()
+	{
+		int err = gettimeofday(&start, NULL);
+		assert(err == 0);
+	}
+
+	/* In seconds */
+	double elapsed() const
+	{
+		struct timeval stop;
+		int err = gettimeofday(&stop, NULL);
+		assert(err == 0);
+
+		struct timeval delta;
+		timersub(&stop, &start, &delta);
+		return delta.tv_sec + 1e-6 * delta.tv_usec;
+	}
+};
+
+}
+
+#endif
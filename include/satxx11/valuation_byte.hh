@@ -0,0 +1,104 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_VALUATION_BYTE_HH
+#define SATXX11_VALUATION_BYTE_HH
+
+#include <cstdint>
+#include <vector>
+
+#include <satxx11/literal.hh>
+
+namespace satxx11 {
+
+/* One signed byte per literal: 1 if the literal is true, -1 if it is false,
+ * and 0 if its variable is unassigned. Uses 8 times as much memory as
+ * valuation_compact, but the value of a literal is a single byte load with
+ * no shifting or masking (and a defined() check followed by a value() check
+ * of the same literal is the very same load). */
+class valuation_byte {
+public:
+	std::vector<int8_t> data;
+
+	template<class Solver>
+	valuation_byte(Solver &s):
+		data(2 * s.nr_variables, 0)
+	{
+	}
+
+	template<class Solver>
+	bool defined(Solver &s, unsigned int variable) const
+	{
+		assert_hotpath(variable < s.nr_variables);
+		return data[2 * variable];
+	}
+
+	template<class Solver>
+	bool defined(Solver &s, literal lit) const
+	{
+		assert_hotpath(lit.variable() < s.nr_variables);
+		return data[lit];
+	}
+
+	template<class Solver>
+	bool value(Solver &s, unsigned int variable) const
+	{
+		assert_hotpath(variable < s.nr_variables);
+		assert_hotpath(defined(s, variable));
+		return data[2 * variable + 1] > 0;
+	}
+
+	template<class Solver>
+	bool value(Solver &s, literal lit) const
+	{
+		assert_hotpath(defined(s, lit));
+		return data[lit] > 0;
+	}
+
+	template<class Solver>
+	void assign(Solver &s, unsigned int variable, bool value)
+	{
+		debug_enter("variable = $, value = $", variable, value);
+
+		assert_hotpath(variable < s.nr_variables);
+		assert_hotpath(!defined(s, variable));
+		data[2 * variable + value] = 1;
+		data[2 * variable + !value] = -1;
+	}
+
+	template<class Solver>
+	void assign(Solver &s, literal lit, bool value)
+	{
+		assign(s, lit.variable(), lit.value() == value);
+	}
+
+	template<class Solver>
+	void unassign(Solver &s, unsigned int variable)
+	{
+		debug_enter("variable = $", variable);
+
+		assert_hotpath(variable < s.nr_variables);
+		assert_hotpath(defined(s, variable));
+		data[2 * variable + 0] = 0;
+		data[2 * variable + 1] = 0;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * SAT solver
+ * Copyright (C) 2011  Vegard Nossum <vegardno@ifi.uio.no>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SATXX11_VARIABLE_REMAP_HH
+#define SATXX11_VARIABLE_REMAP_HH
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <satxx11/assert_hotpath.hh>
+
+namespace satxx11 {
+
+typedef unsigned int variable;
+
+/* Maps the variable numbers of the input file to the range [0, n - 1],
+ * where n is the total number of variables, in order of first appearance.
+ *
+ * Input variables are looked up in a flat array which is sized from the
+ * problem line. Files without a problem line (or with variables that are
+ * numbered far outside the announced range) fall back to a hash table, so
+ * that a few huge variable numbers don't make us allocate a huge array. */
+class variable_remap {
+public:
+	static const variable none = ~0U;
+
+	/* Indexed by input variable */
+	std::vector<variable> dense;
+	std::unordered_map<variable, variable> sparse;
+
+	/* Indexed by solver variable; gives the input variable */
+	std::vector<variable> reverse;
+
+	variable_remap()
+	{
+	}
+
+	unsigned int size() const
+	{
+		return reverse.size();
+	}
+
+	void grow(unsigned long size)
+	{
+		dense.resize(size, none);
+
+		/* Move any variables that are now covered by the array out
+		 * of the hash table. */
+		for (auto it = sparse.begin(); it != sparse.end(); ) {
+			if (it->first < size) {
+				dense[it->first] = it->second;
+				it = sparse.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	/* Called with the number of variables from the problem line. This
+	 * allocates memory right away, so the caller must not pass in more
+	 * than the input can possibly contain. */
+	void reserve(unsigned long nr_variables)
+	{
+		if (dense.size() <= nr_variables)
+			grow(nr_variables + 1);
+
+		reverse.reserve(nr_variables);
+	}
+
+	/* Returns the solver variable for the given input variable, or
+	 * none if the variable hasn't been seen yet. */
+	variable find(variable v) const
+	{
+		if (v < dense.size())
+			return dense[v];
+
+		auto it = sparse.find(v);
+		if (it == sparse.end())
+			return none;
+
+		return it->second;
+	}
+
+	/* Returns the solver variable for the given input variable,
+	 * allocating a new one if the variable hasn't been seen yet. */
+	variable operator()(variable v)
+	{
+		if (v >= dense.size()) {
+			/* Only grow the array if the numbering is reasonably
+			 * dense; we never want the array to be much larger
+			 * than the number of variables that we've seen. */
+			unsigned long limit = 4 * (reverse.size() + 1024);
+			if (v < limit) {
+				grow(std::min<unsigned long>(limit, std::max<unsigned long>(v + 1, 2 * dense.size())));
+			} else {
+				auto it = sparse.insert(std::make_pair(v, reverse.size()));
+				if (it.second)
+					reverse.push_back(v);
+
+				return it.first->second;
+			}
+		}
+
+		variable &x = dense[v];
+		if (x == none) {
+			x = reverse.size();
+			reverse.push_back(v);
+		}
+
+		return x;
+	}
+
+	/* Returns the input variable for the given solver variable. */
+	variable operator[](variable v) const
+	{
+		assert_hotpath(v < reverse.size());
+		return reverse[v];
+	}
+
+	/* Call f(input variable, solver variable) for every variable in
+	 * increasing order of input variable. */
+	template<typename Function>
+	void for_each(Function f) const
+	{
+		for (variable i = 0, n = dense.size(); i < n; ++i) {
+			if (dense[i] != none)
+				f(i, dense[i]);
+		}
+
+		if (sparse.empty())
+			return;
+
+		std::vector<std::pair<variable, variable>> v(sparse.begin(), sparse.end());
+		std::sort(v.begin(), v.end());
+
+		for (const std::pair<variable, variable> &x: v)
+			f(x.first, x.second);
+	}
+};
+
+const variable variable_remap::none;
+
+}
+
+#endif
@@ -22,24 +22,44 @@
 #include <vector>
 
 #include <satxx11/clause.hh>
+#include <satxx11/literal.hh>
 
 namespace satxx11 {
 
 class watchlist {
 public:
+	/* Each watch carries a "blocking" literal from the clause. If the
+	 * blocking literal is true, the clause is satisfied and there is
+	 * nothing to do, so we can skip it without looking at the clause. */
+	class entry {
+	public:
+		clause c;
+		literal blocker;
+
+		entry()
+		{
+		}
+
+		entry(clause c, literal blocker):
+			c(c),
+			blocker(blocker)
+		{
+		}
+	};
+
 	/* XXX: Turn into a single pointer */
-	std::vector<clause> watches;
+	std::vector<entry> watches;
 
 	watchlist()
 	{
 	}
 
-	const clause operator[](unsigned int i) const
+	const entry &operator[](unsigned int i) const
 	{
 		return watches[i];
 	}
 
-	clause &operator[](unsigned int i)
+	entry &operator[](unsigned int i)
 	{
 		return watches[i];
 	}
@@ -49,16 +69,16 @@ public:
 		return watches.size();
 	}
 
-	void insert(clause c)
+	void insert(clause c, literal blocker)
 	{
-		watches.push_back(c);
+		watches.push_back(entry(c, blocker));
 	}
 
 	void remove(clause c)
 	{
 		unsigned int size = watches.size();
 		for (unsigned int i = 0; i < size; ++i) {
-			if (watches[i] == c) {
+			if (watches[i].c == c) {
 				watches[i] = watches[size - 1];
 				watches.pop_back();
 				return;
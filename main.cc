@@ -19,16 +19,17 @@
 #include <atomic>
 #include <cstdint>
 #include <cstdio>
-#include <fstream>
+#include <exception>
 #include <iostream>
-#include <map>
-#include <sstream>
+#include <memory>
 #include <thread>
 
 #include <boost/program_options.hpp>
 
 extern "C" {
+#include <fcntl.h>
 #include <signal.h>
+#include <unistd.h>
 
 #include <sys/resource.h>
 #include <sys/sysinfo.h>
@@ -38,77 +39,70 @@ extern "C" {
 #include <satxx11/assert.hh>
 #include <satxx11/clause.hh>
 #include <satxx11/binary_clause.hh>
+#include <satxx11/binary_cnf.hh>
+#include <satxx11/clause_store.hh>
+#include <satxx11/cnf.hh>
 #include <satxx11/debug.hh>
+#include <satxx11/dimacs_parser.hh>
 #include <satxx11/literal.hh>
+#include <satxx11/mapped_file.hh>
 #include <satxx11/solver.hh>
+#include <satxx11/ternary_clause.hh>
+#include <satxx11/variable_remap.hh>
 
 #include ".git_diff.hh"
 #include ".git_diff_cached.hh"
 
 using namespace satxx11;
 
-typedef unsigned int variable;
-typedef std::map<variable, variable> variable_map;
-typedef std::vector<literal> literal_vector;
-typedef std::vector<literal_vector> literal_vector_vector;
-
-void read_cnf(std::istream &file,
-	variable_map &variables, variable_map &reverse_variables,
-	literal_vector_vector &clauses)
+static void read_cnf(int fd, unsigned int nr_threads, variable_remap &variables, cnf &clauses)
 {
-	while (!file.eof()) {
-		std::string line;
-		getline(file, line);
-
-		if (line.size() == 0)
-			continue;
+	struct timeval time_start;
+	{
+		int err = gettimeofday(&time_start, NULL);
+		assert(err == 0);
+	}
 
-		/* Skip problem line -- we don't use it anyway */
-		if (line[0] == 'p')
-			continue;
+	unsigned long nr_bytes;
 
-		/* Skip comments */
-		if (line[0] == 'c')
-			continue;
+	std::unique_ptr<mapped_file> file(new mapped_file(fd));
+	if (*file && binary_cnf::check(file->data, file->size)) {
+		printf("c Input is a binary CNF file\n");
 
-		/* XOR clauses */
-		if (line[0] == 'x')
-			throw std::runtime_error("Cannot read XOR clauses");
+		nr_bytes = file->size;
+		binary_cnf::load(std::move(file), variables, clauses);
+	} else {
+		if (clauses.file)
+			throw std::runtime_error("Binary CNF files cannot be combined with other input files");
 
-		literal_vector c;
+		dimacs_parser parser(&variables, clauses);
+		if (*file)
+			parser.parse_mapped(file->data, file->size, nr_threads);
+		else
+			parser.parse_stream(fd);
 
-		std::stringstream s(line);
-		while (!s.eof()) {
-			int x;
-			s >> x;
+		if (parser.input_compression != COMPRESSION_NONE)
+			printf("c Input is %s-compressed\n", compression_name(parser.input_compression));
 
-			if (x == 0)
-				break;
+		nr_bytes = parser.nr_bytes;
+	}
 
-			variable v = abs(x);
+	struct timeval time_stop;
+	{
+		int err = gettimeofday(&time_stop, NULL);
+		assert(err == 0);
+	}
 
-			/* We remap variables to the range [0, n - 1], where
-			 * n is the total number of variables. */
-			variable v2;
-			variable_map::iterator it = variables.find(v);
-			if (it == variables.end()) {
-				v2 = variables.size();
-				variables[v] = v2;
-				reverse_variables[v2] = v;
-			} else {
-				v2 = it->second;
-			}
+	struct timeval delta;
+	timersub(&time_stop, &time_start, &delta);
 
-			c.push_back(literal(v2, x > 0));
-		}
+	double seconds = delta.tv_sec + 1e-6 * delta.tv_usec;
+	printf("c Parsed %lu bytes in %lu.%06lu s (%.2f MB/s)\n",
+		nr_bytes, delta.tv_sec, delta.tv_usec,
+		seconds > 0 ? nr_bytes / seconds / (1 << 20) : 0.);
 
-		clauses.push_back(c);
-	}
-
-	printf("c Variables: %lu\n", variables.size());
+	printf("c Variables: %u\n", variables.size());
 	printf("c Clauses: %lu\n", clauses.size());
-
-	assert(variables.size() == reverse_variables.size());
 }
 
 static bool keep_going = false;
@@ -127,66 +121,156 @@ static void handle_sigint(int signum, ::siginfo_t *info, void *unused)
 }
 
 template<typename t>
-static void solve(t *s)
+static void solve(t *s, std::exception_ptr *error)
 {
-	s->run();
+	/* An exception must not escape the thread, so stop the other
+	 * threads and let the main thread report the error instead. */
+	try {
+		s->run();
+	} catch (...) {
+		*error = std::current_exception();
+		should_exit = true;
+	}
 }
 
+/* The reason why a variable was set, packed into 64 bits. The low two bits
+ * select the type and the rest is the payload:
+ *
+ *   DECISION         -
+ *   BINARY_CLAUSE    the other literal of the clause
+ *   TERNARY_CLAUSE   the two other literals of the clause (31 bits each)
+ *   CLAUSE           the clause reference
+ *
+ * Binary and ternary clauses don't exist in memory, so we only keep the
+ * literals that are not the implied literal itself. The propagation engines
+ * therefore always put the implied literal first when they construct a
+ * binary_clause or ternary_clause reason. */
 class reason {
 public:
 	enum {
 		DECISION,
 		BINARY_CLAUSE,
+		TERNARY_CLAUSE,
 		CLAUSE,
-	} type;
+	};
+
+	static const unsigned int max_variables = 1U << 30;
+
+	/* The literals of a reason, for iterating over in place. The implied
+	 * literal comes first (except for long clauses, where the literals
+	 * come in the order they are stored in). */
+	class literal_range {
+	public:
+		literal buffer[3];
+		const literal *first;
+		unsigned int size;
 
-	union {
-		binary_clause binary_clause_data;
-		clause clause_data;
+		const literal *begin() const
+		{
+			return first ? first : buffer;
+		}
+
+		const literal *end() const
+		{
+			return begin() + size;
+		}
 	};
 
+	uint64_t x;
+
 	reason():
-		type(DECISION)
+		x(DECISION)
 	{
 	}
 
 	reason(binary_clause c):
-		type(BINARY_CLAUSE),
-		binary_clause_data(c)
+		x(BINARY_CLAUSE | (uint64_t) c.b << 2)
 	{
 	}
 
+	reason(ternary_clause c):
+		x(TERNARY_CLAUSE | (uint64_t) c.b << 2 | (uint64_t) c.c << 33)
+	{
+		assert_hotpath(c.b < 2 * max_variables);
+		assert_hotpath(c.c < 2 * max_variables);
+	}
+
 	reason(clause c):
-		type(CLAUSE),
-		clause_data(c)
+		x(CLAUSE | (uint64_t) c.ref << 2)
 	{
 	}
 
-	void get_literals(std::vector<literal> &v) const
+	unsigned int type() const
 	{
-		assert_hotpath(clause_data);
+		return x & 3;
+	}
 
-		v.clear();
-		switch (type) {
+	literal at(unsigned int shift) const
+	{
+		literal lit;
+		lit.x = (x >> shift) & 0x7fffffff;
+		return lit;
+	}
+
+	clause clause_data() const
+	{
+		return clause(x >> 2);
+	}
+
+	/* The long clause this is the reason for, if any. */
+	clause get_clause() const
+	{
+		return type() == CLAUSE ? clause_data() : clause();
+	}
+
+	/* lit is the literal that this is the reason for; for a conflict,
+	 * it is the conflicting literal. */
+	literal_range literals(literal lit) const
+	{
+		literal_range r;
+		r.first = 0;
+		r.buffer[0] = lit;
+
+		switch (type()) {
 		case DECISION:
+			r.size = 0;
 			break;
 		case BINARY_CLAUSE:
-			binary_clause_data.get_literals(v);
+			r.buffer[1].x = x >> 2;
+			r.size = 2;
+			break;
+		case TERNARY_CLAUSE:
+			r.buffer[1] = at(2);
+			r.buffer[2] = at(33);
+			r.size = 3;
 			break;
 		case CLAUSE:
-			clause_data.get_literals(v);
+			{
+				clause::impl *data = clause_data().get();
+				r.first = data->literals;
+				r.size = data->size;
+			}
 			break;
-		default:
-			assert(false);
 		}
+
+		return r;
+	}
+
+	template<typename Function>
+	void relocate(Function f)
+	{
+		if (type() == CLAUSE)
+			x = CLAUSE | (uint64_t) f(clause_data()).ref << 2;
 	}
 
 	operator bool() const
 	{
-		return type != DECISION;
+		return type() != DECISION;
 	}
 };
 
+static_assert(sizeof(reason) == 8, "sizeof(reason) == 8");
+
 int main(int argc, char *argv[])
 {
 	typedef solver<reason> my_solver;
@@ -221,6 +305,7 @@ int main(int argc, char *argv[])
 	}
 
 	std::vector<std::string> input_files;
+	std::string convert_file;
 
 	/* Process command line */
 	{
@@ -233,6 +318,7 @@ int main(int argc, char *argv[])
 			("threads", value<unsigned int>(&nr_threads), "number of threads")
 			("seed", value<unsigned long>(&seed), "random number seed")
 			("input", value<std::vector<std::string> >(&input_files), "input file")
+			("convert", value<std::string>(&convert_file), "write the instance to the given file in binary CNF format and exit")
 		;
 
 		options_description debug_options("Debugging options");
@@ -299,25 +385,38 @@ int main(int argc, char *argv[])
 	printf("c Using random number seed %lu\n", seed);
 
 	/* Read instance */
-	variable_map variables;
-	variable_map reverse_variables;
-	literal_vector_vector clauses;
+	variable_remap variables;
+	cnf clauses;
 
 	if (input_files.size() >= 1) {
 		for (unsigned int i = 0; i < input_files.size(); ++i) {
-			std::ifstream file;
-
-			file.open(input_files[i].c_str());
-			if (!file)
+			int fd = open(input_files[i].c_str(), O_RDONLY);
+			if (fd == -1)
 				throw std::runtime_error("Could not open file");
 
 			printf("c Reading %s\n", input_files[i].c_str());
-			read_cnf(file, variables, reverse_variables, clauses);
-			file.close();
+			read_cnf(fd, nr_threads, variables, clauses);
+			close(fd);
 		}
 	} else {
 		printf("c Reading standard input\n");
-		read_cnf(std::cin, variables, reverse_variables, clauses);
+		read_cnf(STDIN_FILENO, nr_threads, variables, clauses);
+	}
+
+	if (variables.size() > reason::max_variables)
+		throw std::runtime_error("Too many variables");
+
+	if (!convert_file.empty()) {
+		FILE *fp = fopen(convert_file.c_str(), "w");
+		if (!fp)
+			throw system_error(errno);
+
+		binary_cnf::save(fp, variables, clauses);
+		if (fclose(fp))
+			throw system_error(errno);
+
+		printf("c Wrote binary CNF file %s\n", convert_file.c_str());
+		return 0;
 	}
 
 	/* Catch Ctrl-C and stop the threads gracefully (NOTE: Do this after
@@ -340,25 +439,50 @@ int main(int argc, char *argv[])
 	 * layer of indirection sometimes. But it makes construction difficult,
 	 * unless we separate some of the initialisation from construction, which
 	 * is admittedly ugly. */
+	clause_store store(nr_threads, variables.size(), clauses);
+
 	my_solver *solvers[nr_threads];
 	for (unsigned int i = 0; i < nr_threads; ++i)
-		solvers[i] = new my_solver(nr_threads, solvers, i, keep_going, should_exit, seed + i, variables, reverse_variables, clauses);
+		solvers[i] = new my_solver(nr_threads, solvers, i, keep_going, should_exit, seed + i, variables, clauses, store);
 
-	for (literal_vector &v: clauses) {
-		/* XXX: We should return UNSAT here instead of failing the assertion. */
-		bool ok = solvers[0]->attach(v);
-		assert(ok);
+	{
+		std::vector<literal> v;
+		for (unsigned long i = 0, n = clauses.size(); i < n; ++i) {
+			cnf::span c = clauses[i];
+			v.assign(c.begin(), c.end());
+
+			/* XXX: We should return UNSAT here instead of failing the assertion. */
+			bool ok = solvers[0]->attach(v);
+			assert(ok);
+		}
 	}
 
+	store.freeze();
+
 	/* Start threads */
 	std::thread *threads[nr_threads];
+	std::exception_ptr errors[nr_threads];
 	for (unsigned int i = 0; i < nr_threads; ++i)
-		threads[i] = new std::thread(solve<my_solver>, solvers[i]);
+		threads[i] = new std::thread(solve<my_solver>, solvers[i], &errors[i]);
 
 	/* Wait for the solvers to finish/exit */
 	for (unsigned int i = 0; i < nr_threads; ++i)
 		threads[i]->join();
 
+	int ret = 0;
+	for (unsigned int i = 0; i < nr_threads; ++i) {
+		if (!errors[i])
+			continue;
+
+		try {
+			std::rethrow_exception(errors[i]);
+		} catch (const std::exception &e) {
+			printf("c Thread %u failed: %s\n", i, e.what());
+		}
+
+		ret = 1;
+	}
+
 	for (unsigned int i = 0; i < nr_threads; ++i)
 		delete solvers[i];
 
@@ -381,5 +505,5 @@ int main(int argc, char *argv[])
 		printf("c Wall time %lu.%06lu\n", delta.tv_sec, delta.tv_usec);
 	}
 
-	return 0;
+	return ret;
 }